@@ -7,7 +7,7 @@
 #ifndef DRIVER_LCD1602_H_
 #define DRIVER_LCD1602_H_
 
-#define LCD_DEBUG 1  // Remove comment on this line to enable debug
+// #define LCD_DEBUG 1  // Remove comment on this line to enable debug
 
 #undef PDEBUG             /* undef it, just in case */
 #ifdef LCD_DEBUG
@@ -21,4 +21,77 @@
 #else
 #  define PDEBUG(fmt, args...) /* not debugging: nothing */
 #endif
+
+/*
+ * The encoder and the other hardware-independent parts of the driver are
+ * also built on the host (see CMakeLists.txt), so give them the kernel
+ * integer types and errno values there too.
+ */
+#ifdef __KERNEL__
+#include <linux/types.h>
+#include <linux/bits.h>
+#include <linux/errno.h>
+#include <linux/string.h>
+#else
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+#define BIT_ULL(nr)  (1ULL << (nr))
+#endif
+
+/* PCF8574 pin definitions*/
+#define LCD_RS    0x01  /* Bit 0 */
+#define LCD_RW    0x02  /* Bit 1 */
+#define LCD_EN    0x04  /* Bit 2 */
+#define LCD_BL    0x08  /* Bit 3 - Backlight */
+
+/*
+cmd ref: https://www.electronicwings.com/sensors-modules/lcd-16x2-display-module
+*/
+
+/* lcd cmds */
+#define LCD_CLEAR           0x01
+#define LCD_HOME            0x02
+#define LCD_ENTRY_MODE      0x04
+#define LCD_DISPLAY_CONTROL 0x08
+#define LCD_FUNCTION_SET    0x20
+#define LCD_CURSOR_SHIFT    0x10
+#define LCD_SET_CGRAM       0x40
+#define LCD_SET_DDRAM       0x80
+
+/* cmd flags */
+#define LCD_ENTRY_LEFT       0x02
+#define LCD_DISPLAY_ON       0x04
+#define LCD_CURSOR_OFF       0x00
+#define LCD_BLINK_OFF        0x00
+#define LCD_4BIT_MODE        0x00
+#define LCD_2LINE            0x08
+#define LCD_5x8DOTS          0x00
+#define LCD_DISPLAY_MOVE     0x08
+#define LCD_CURSOR_MOVE      0x00
+#define LCD_MOVE_RIGHT       0x04
+#define LCD_MOVE_LEFT        0x00
+
+/* display geometry, row 1 starts at DDRAM 0x40 in 2-line mode */
+#define LCD_ROWS       2
+#define LCD_COLS       16
+#define LCD_ROW_ADDR(row)  ((row) ? 0x40 : 0x00)
+/* each row has 40 bytes of DDRAM, only the first 16 are on the glass */
+#define LCD_DDRAM_COLS 40
+/* full screens that fit side by side in DDRAM, shown via display shift */
+#define LCD_PAGES      (LCD_DDRAM_COLS / LCD_COLS)
+
+/*
+ * Copy of the controller's DDRAM as the driver wants it to be, with one
+ * dirty bit per cell that may differ from what is on the glass.
+ */
+struct lcd_shadow {
+    u8 ddram[LCD_ROWS][LCD_DDRAM_COLS];
+    u64 dirty[LCD_ROWS];  /* bit n = column n */
+};
 #endif  // DRIVER_LCD1602_H_
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * PCF8574 port-byte stream encoder, see lcd1602_encode.h
+ */
+
+#include "driver/lcd1602_encode.h"
+
+static unsigned int lcd_residual_us(unsigned int need_ns,
+                                    unsigned int covered_ns) {
+    if (need_ns <= covered_ns)
+        return 0;
+    return (need_ns - covered_ns + 999) / 1000;
+}
+
+void lcd_timing_init(struct lcd_timing *t, u32 bus_hz) {
+    unsigned int covered, gap;
+
+    t->bus_hz = bus_hz;
+    t->byte_ns = 9 * (1000000000U / bus_hz);
+    covered = 2 * t->byte_ns;
+
+    /* bytes needed between the last EN edge of one byte and the next */
+    gap = (LCD_EXEC_NS + t->byte_ns - 1) / t->byte_ns;
+    t->pad_bytes = gap > 2 ? gap - 2 : 0;
+
+    t->slow_cmd_us = lcd_residual_us(LCD_SLOW_EXEC_NS, covered);
+    t->init_long_us = lcd_residual_us(LCD_INIT_LONG_NS, covered);
+    t->init_short_us = lcd_residual_us(LCD_INIT_SHORT_NS, covered);
+}
+
+int lcd_pinmap_set(struct lcd_pinmap *map, const u32 *pins) {
+    unsigned int i;
+    u32 used = 0;
+
+    for (i = 0; i < LCD_PINMAP_LEN; i++) {
+        if (pins[i] > 7 || (used & (1U << pins[i])))
+            return -EINVAL;
+        used |= 1U << pins[i];
+    }
+    map->rs = pins[0];
+    map->rw = pins[1];
+    map->en = pins[2];
+    map->bl = pins[3];
+    for (i = 0; i < 4; i++)
+        map->data[i] = pins[4 + i];
+    return 0;
+}
+
+/* port state for the low 4 bits of nibble on the data pins */
+static u8 lcd_encode_nibble(const struct lcd_pinmap *map, u8 nibble) {
+    unsigned int i;
+    u8 port = 0;
+
+    for (i = 0; i < 4; i++)
+        if (nibble & (1U << i))
+            port |= 1U << map->data[i];
+    return port;
+}
+
+void lcd_encoder_init(struct lcd_encoder *e, const struct lcd_pinmap *map,
+                      u8 backlight) {
+    unsigned int rs, val;
+    u8 *seq, hi, lo;
+
+    e->map = *map;
+    e->en = 1U << map->en;
+    /* quasi-bidirectional pins read back what the LCD drives once set high */
+    e->read_port = lcd_encode_nibble(map, 0x0F) | (1U << map->rw) |
+                   (backlight ? 1U << map->bl : 0);
+    for (rs = 0; rs < 2; rs++) {
+        for (val = 0; val < 16; val++)
+            e->nibble[rs][val] = lcd_encode_nibble(map, val) |
+                                 (rs ? 1U << map->rs : 0) |
+                                 (backlight ? 1U << map->bl : 0);
+        for (val = 0; val < 256; val++) {
+            hi = e->nibble[rs][val >> 4];
+            lo = e->nibble[rs][val & 0x0F];
+            seq = e->byte[rs][val];
+            seq[0] = hi | e->en;
+            seq[1] = hi;
+            seq[2] = lo | e->en;
+            seq[3] = lo;
+        }
+    }
+}
+
+u8 lcd_encoder_decode(const struct lcd_encoder *e, u8 port) {
+    unsigned int i;
+    u8 nibble = 0;
+
+    for (i = 0; i < 4; i++)
+        if (port & (1U << e->map.data[i]))
+            nibble |= 1U << i;
+    return nibble;
+}
+
+void lcd_stream_init(struct lcd_stream *s, const struct lcd_encoder *enc,
+                     u8 pad) {
+    s->len = 0;
+    s->max = pad <= LCD_PAD_MAX ? LCD_STREAM_FRAME(pad) : LCD_STREAM_MAX;
+    s->enc = enc;
+    s->pad = pad;
+    s->rs = LCD_STREAM_RS_NONE;
+}
+
+void lcd_stream_reset(struct lcd_stream *s) {
+    s->len = 0;
+    s->rs = LCD_STREAM_RS_NONE;
+}
+
+void lcd_stream_limit(struct lcd_stream *s, unsigned int max) {
+    if (max < s->max)
+        s->max = max;
+}
+
+int lcd_stream_power_on(struct lcd_stream *s) {
+    if (s->len + 1 > s->max)
+        return -ENOSPC;
+    s->buf[s->len++] = (u8)~s->enc->en;
+    s->rs = LCD_STREAM_RS_NONE;
+    return 0;
+}
+
+/* 1 if RS/RW have to settle in an EN-low byte before port goes out */
+static unsigned int lcd_stream_setup(const struct lcd_stream *s, u8 rs) {
+    return s->rs != rs;
+}
+
+int lcd_stream_nibble(struct lcd_stream *s, u8 nibble, u8 rs) {
+    u8 port = s->enc->nibble[!!rs][nibble & 0x0F];
+    unsigned int setup = lcd_stream_setup(s, !!rs);
+
+    if (s->len + setup + LCD_PORT_BYTES / 2 > s->max)
+        return -ENOSPC;
+    if (setup)
+        s->buf[s->len++] = port;
+    s->buf[s->len++] = port | s->enc->en;
+    s->buf[s->len++] = port;
+    s->rs = !!rs;
+    return 0;
+}
+
+int lcd_stream_byte(struct lcd_stream *s, u8 val, u8 rs) {
+    const u8 *seq = s->enc->byte[!!rs][val];
+    unsigned int setup = lcd_stream_setup(s, !!rs);
+    unsigned int i;
+
+    if (s->len + setup + lcd_stream_byte_cost(s) > s->max)
+        return -ENOSPC;
+    /* the high nibble with EN low */
+    if (setup)
+        s->buf[s->len++] = seq[1];
+    memcpy(s->buf + s->len, seq, LCD_PORT_BYTES);
+    s->len += LCD_PORT_BYTES;
+    /* repeat the idle port state until the controller is done */
+    for (i = 0; i < s->pad; i++, s->len++)
+        s->buf[s->len] = s->buf[s->len - 1];
+    s->rs = !!rs;
+    return 0;
+}
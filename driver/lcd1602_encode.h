@@ -0,0 +1,170 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * PCF8574 port-byte stream encoder for the HD44780 4-bit interface
+ *
+ * The PCF8574 latches every byte of a write transaction onto P0-P7 as it
+ * arrives, so the EN high/low edges for any number of nibbles can be
+ * carried by one i2c_msg. Each HD44780 byte becomes four port bytes:
+ *
+ *   hi|EN, hi, lo|EN, lo
+ *
+ * RS and RW must be stable for tAS (40-60ns) before EN rises, so whenever
+ * they change the byte is preceded by one setup byte, the high nibble with
+ * EN low. The port state between messages is not tracked (a busy-flag read
+ * leaves RW high, a failed transfer leaves it unknown), so every message
+ * starts with a setup byte too. Data lines change in the EN-high byte and
+ * stay stable for a full I2C byte time (~9us even at 1MHz) before EN falls,
+ * far above the 450ns pulse width and 80ns data setup the controller needs.
+ *
+ * The two bytes between consecutive falling edges are also the only gap
+ * the controller gets to execute a data write or short command (37us).
+ * Up to 400kHz that is already enough, so no delay is needed at all; on
+ * faster buses struct lcd_timing asks for idle port bytes after each
+ * HD44780 byte, which keeps the whole run in one message.
+ *
+ * Which P-pin carries which signal depends on the backpack, so the port
+ * bytes come from a table built once for the wiring: the four bytes of
+ * every (RS, byte) pair, backlight included. Appending a byte is a copy
+ * whatever the wiring.
+ */
+#ifndef DRIVER_LCD1602_ENCODE_H_
+#define DRIVER_LCD1602_ENCODE_H_
+
+#include "driver/lcd1602.h"
+
+/* port bytes needed for one HD44780 byte (two nibbles, two EN edges) */
+#define LCD_PORT_BYTES  4
+
+/* HD44780 execution times at the 270kHz nominal clock, plus ~10% margin */
+#define LCD_EXEC_NS         40000     /* data write, short command: 37us */
+#define LCD_SLOW_EXEC_NS    1700000   /* clear, home: 1.52ms */
+#define LCD_INIT_LONG_NS    4500000   /* after the first 0x3 nibble: 4.1ms */
+#define LCD_INIT_SHORT_NS   150000    /* after the other init nibbles: 100us */
+
+/*
+ * Which waits the bus already covers at a given clock. A message always
+ * spends at least two byte times (STOP/START plus address) between the
+ * last EN edge of one message and the first of the next, so only what is
+ * left of each wait after that needs a sleep.
+ */
+struct lcd_timing {
+    u32 bus_hz;
+    u32 byte_ns;                /* one I2C byte is 9 clocks */
+    unsigned int pad_bytes;     /* idle port bytes after each HD44780 byte */
+    unsigned int slow_cmd_us;   /* sleep after clear/home */
+    unsigned int init_long_us;  /* sleep after the first init nibble */
+    unsigned int init_short_us; /* sleep after the other init nibbles */
+};
+
+/*
+ * Fastest clock the plan is made for: 9 clocks per byte have to leave
+ * byte_ns well above 0. Anything faster is a bogus "clock-frequency".
+ */
+#define LCD_BUS_HZ_MAX  5000000
+
+/* bus_hz in 1..LCD_BUS_HZ_MAX */
+void lcd_timing_init(struct lcd_timing *t, u32 bus_hz);
+
+/* pad_bytes of the plan at LCD_BUS_HZ_MAX, the most any plan asks for */
+#define LCD_BYTE_NS_MIN  (9 * (1000000000U / LCD_BUS_HZ_MAX))
+#define LCD_PAD_MAX \
+    ((LCD_EXEC_NS + LCD_BYTE_NS_MIN - 1) / LCD_BYTE_NS_MIN - 2)
+
+/* P-pin (0-7) of each signal */
+struct lcd_pinmap {
+    u8 rs;
+    u8 rw;
+    u8 en;
+    u8 bl;
+    u8 data[4];     /* D4-D7 */
+};
+
+/* the layout documented in lcd1602_main.c and lcd1602.h */
+#define LCD_PINMAP_DEFAULT { \
+    .rs = 0, .rw = 1, .en = 2, .bl = 3, .data = { 4, 5, 6, 7 }, \
+}
+
+/* signals in the order of the "pin-map" property and pinmap parameter */
+#define LCD_PINMAP_LEN  8
+
+/*
+ * Fill map from pins[] = RS, RW, EN, BL, D4, D5, D6, D7. -EINVAL unless
+ * every pin is 0-7 and no two signals share one.
+ */
+int lcd_pinmap_set(struct lcd_pinmap *map, const u32 *pins);
+
+struct lcd_encoder {
+    u8 byte[2][256][LCD_PORT_BYTES];    /* [rs][val]: hi|EN, hi, lo|EN, lo */
+    u8 nibble[2][16];                   /* [rs][nibble], EN low */
+    u8 en;                              /* port bit of EN */
+    u8 read_port;   /* D4-D7 released for reading, RW high, EN low */
+    struct lcd_pinmap map;
+};
+
+/* fill the tables for a wiring, backlight on or off */
+void lcd_encoder_init(struct lcd_encoder *e, const struct lcd_pinmap *map,
+                      u8 backlight);
+
+/* nibble on D4-D7 of a port byte read back from the PCF8574 */
+u8 lcd_encoder_decode(const struct lcd_encoder *e, u8 port);
+
+/*
+ * a full 16x2 frame plus one Set-DDRAM command per row, with the setup
+ * bytes of the two RS changes per row and pad idle bytes after each
+ * HD44780 byte
+ */
+#define LCD_STREAM_FRAME(pad) \
+    (LCD_ROWS * ((LCD_COLS + 1) * (LCD_PORT_BYTES + (pad)) + 2))
+
+/* so a full frame fits one message at any bus clock */
+#define LCD_STREAM_MAX  LCD_STREAM_FRAME(LCD_PAD_MAX)
+
+/* lcd_stream.rs at the start of a message, RS/RW not known */
+#define LCD_STREAM_RS_NONE  0xFF
+
+struct lcd_stream {
+    u8 buf[LCD_STREAM_MAX];
+    unsigned int len;
+    unsigned int max;   /* message size limit, a full frame at init */
+    const struct lcd_encoder *enc;
+    u8 pad;             /* lcd_timing.pad_bytes */
+    u8 rs;              /* RS of the last port byte, or LCD_STREAM_RS_NONE */
+};
+
+void lcd_stream_init(struct lcd_stream *s, const struct lcd_encoder *enc,
+                     u8 pad);
+void lcd_stream_reset(struct lcd_stream *s);
+
+/* cap messages at max port bytes for adapters that cannot take a full one */
+void lcd_stream_limit(struct lcd_stream *s, unsigned int max);
+
+/*
+ * The PCF8574 powers up with every pin high, EN included, so the first
+ * EN-low byte is a falling edge. Append a byte that drops only EN: with RW
+ * still high the controller takes it as a read and ignores it, and the
+ * next setup byte is not an edge. Harmless when EN is already low.
+ * -ENOSPC when full.
+ */
+int lcd_stream_power_on(struct lcd_stream *s);
+
+/* append a single nibble (init sequence only), -ENOSPC when full */
+int lcd_stream_nibble(struct lcd_stream *s, u8 nibble, u8 rs);
+
+/* append a full byte as two nibbles, -ENOSPC when full */
+int lcd_stream_byte(struct lcd_stream *s, u8 val, u8 rs);
+
+/* port bytes one HD44780 byte occupies in this stream, setup byte aside */
+static inline unsigned int lcd_stream_byte_cost(const struct lcd_stream *s) {
+    return LCD_PORT_BYTES + s->pad;
+}
+
+/* HD44780 bytes that still fit, counting a setup byte unless RS is known */
+static inline unsigned int lcd_stream_space(const struct lcd_stream *s) {
+    unsigned int setup = s->rs == LCD_STREAM_RS_NONE;
+
+    if (s->len + setup >= s->max)
+        return 0;
+    return (s->max - s->len - setup) / lcd_stream_byte_cost(s);
+}
+
+#endif  // DRIVER_LCD1602_ENCODE_H_
@@ -0,0 +1,222 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * Plan executor, see lcd1602_exec.h
+ */
+
+#include "driver/lcd1602_exec.h"
+
+void lcd_exec_init(struct lcd_exec *x, const struct lcd_exec_ops *ops,
+                   void *ctx, const struct lcd_encoder *enc,
+                   const struct lcd_timing *timing) {
+    x->ops = ops;
+    x->ctx = ctx;
+    x->timing = timing;
+    lcd_stream_init(&x->stream, enc, timing->pad_bytes);
+    lcd_cost_model_init(&x->cost, lcd_stream_byte_cost(&x->stream),
+                        timing->byte_ns);
+    x->plan.nops = 0;
+    x->plan.ac = LCD_AC_UNKNOWN;
+    x->plan.shift = LCD_SHIFT_UNKNOWN;
+    x->batching = 0;
+    x->ac = LCD_AC_UNKNOWN;
+    x->shift = LCD_SHIFT_UNKNOWN;
+}
+
+int lcd_exec_xfer(struct lcd_exec *x) {
+    int ret;
+
+    if (!x->stream.len)
+        return 0;
+    ret = x->ops->xfer(x->ctx, x->stream.buf, x->stream.len);
+    lcd_stream_reset(&x->stream);
+    return ret;
+}
+
+int lcd_exec_emit(struct lcd_exec *x, u8 val, u8 rs) {
+    int ret;
+
+    if (lcd_stream_byte(&x->stream, val, rs) == 0)
+        return 0;
+    if (x->batching)
+        return -ENOSPC;
+    ret = lcd_exec_xfer(x);
+    if (ret)
+        return ret;
+    return lcd_stream_byte(&x->stream, val, rs);
+}
+
+static void lcd_exec_sleep(struct lcd_exec *x, unsigned int us) {
+    if (us)
+        x->ops->sleep_us(x->ctx, us);
+}
+
+int lcd_exec_command(struct lcd_exec *x, u8 cmd) {
+    int ret;
+
+    ret = lcd_exec_emit(x, cmd, 0);
+    if (ret)
+        return ret;
+    /* clear/home are the only commands slower than the bus itself */
+    if (cmd == LCD_CLEAR || cmd == LCD_HOME) {
+        ret = lcd_exec_xfer(x);
+        if (ret)
+            return ret;
+        if (x->ops->wait_slow)
+            return x->ops->wait_slow(x->ctx);
+        lcd_exec_sleep(x, x->timing->slow_cmd_us);
+    }
+    return 0;
+}
+
+/* a lone nibble in a message of its own, then its wait */
+static int lcd_exec_nibble(struct lcd_exec *x, u8 nibble,
+                           unsigned int delay_us) {
+    int ret;
+
+    ret = lcd_stream_nibble(&x->stream, nibble, 0);
+    if (!ret)
+        ret = lcd_exec_xfer(x);
+    lcd_exec_sleep(x, delay_us);
+    return ret;
+}
+
+int lcd_exec_reset(struct lcd_exec *x) {
+    const struct lcd_timing *t = x->timing;
+    int ret;
+
+    lcd_stream_reset(&x->stream);
+    lcd_exec_sleep(x, LCD_POWER_ON_US);
+    lcd_stream_power_on(&x->stream);
+    ret = lcd_exec_nibble(x, 0x03, t->init_long_us);
+    if (!ret)
+        ret = lcd_exec_nibble(x, 0x03, t->init_short_us);
+    if (!ret)
+        ret = lcd_exec_nibble(x, 0x03, t->init_short_us);
+    if (!ret)
+        ret = lcd_exec_nibble(x, 0x02, t->init_short_us);
+    return ret;
+}
+
+int lcd_exec_configure(struct lcd_exec *x) {
+    int ret;
+
+    /*
+     * from here on whole bytes, batched into as few messages as possible,
+     * and BF is valid, so wait_slow may poll it for the clear
+     */
+    ret = lcd_exec_command(x, LCD_FUNCTION_SET | LCD_4BIT_MODE |
+                           LCD_2LINE | LCD_5x8DOTS);
+    if (!ret)
+        ret = lcd_exec_command(x, LCD_DISPLAY_CONTROL | LCD_DISPLAY_ON |
+                               LCD_CURSOR_OFF | LCD_BLINK_OFF);
+    if (!ret)
+        ret = lcd_exec_command(x, LCD_CLEAR);
+    if (!ret)
+        ret = lcd_exec_command(x, LCD_ENTRY_MODE | LCD_ENTRY_LEFT);
+    if (!ret)
+        ret = lcd_exec_xfer(x);
+    x->ac = ret ? LCD_AC_UNKNOWN : 0;
+    x->shift = ret ? LCD_SHIFT_UNKNOWN : 0;
+    return ret;
+}
+
+/*
+ * send the frame's glyphs to CGRAM, adjacent slots share one Set-CGRAM
+ * command since the address counter runs on from slot to slot
+ */
+static int lcd_exec_upload(struct lcd_exec *x, const struct lcd_frame *f) {
+    unsigned int slot, row;
+    int addressed = 0;
+    int ret = 0;
+
+    for (slot = 0; slot < LCD_CGRAM_SLOTS && !ret; slot++) {
+        if (!(f->uploads & (1U << slot))) {
+            addressed = 0;
+            continue;
+        }
+        if (!addressed)
+            ret = lcd_exec_emit(x, LCD_SET_CGRAM | (slot * LCD_GLYPH_ROWS), 0);
+        addressed = 1;
+        for (row = 0; row < LCD_GLYPH_ROWS && !ret; row++)
+            ret = lcd_exec_emit(x, f->glyphs[slot][row], 1);
+    }
+    /* the address counter now points into CGRAM */
+    x->ac = LCD_AC_UNKNOWN;
+    return ret;
+}
+
+/* clear and home have to be sent on their own and waited for */
+static int lcd_plan_is_slow(const struct lcd_plan *plan) {
+    unsigned int i;
+
+    for (i = 0; i < plan->nops; i++)
+        if (plan->ops[i].type == LCD_OP_CLEAR ||
+            plan->ops[i].type == LCD_OP_HOME)
+            return 1;
+    return 0;
+}
+
+static int lcd_exec_op(struct lcd_exec *x, const struct lcd_op *op,
+                       const struct lcd_shadow *sh) {
+    unsigned int n;
+    int ret = 0;
+
+    switch (op->type) {
+    case LCD_OP_CLEAR:
+        return lcd_exec_command(x, LCD_CLEAR);
+    case LCD_OP_ADDR:
+        return lcd_exec_emit(x, LCD_SET_DDRAM |
+                             (LCD_ROW_ADDR(op->row) + op->col), 0);
+    case LCD_OP_DATA:
+        for (n = 0; n < op->len && !ret; n++)
+            ret = lcd_exec_emit(x, sh->ddram[op->row][op->col + n], 1);
+        return ret;
+    case LCD_OP_HOME:
+        return lcd_exec_command(x, LCD_HOME);
+    case LCD_OP_SHIFT:
+        for (n = 0; n < op->len && !ret; n++)
+            ret = lcd_exec_emit(x, LCD_CURSOR_SHIFT | LCD_DISPLAY_MOVE |
+                                op->col, 0);
+        return ret;
+    }
+    return 0;
+}
+
+int lcd_exec_flush(struct lcd_exec *x, const struct lcd_frame *f, int batch) {
+    struct lcd_plan *plan = &x->plan;
+    int ac = x->ac, shift = x->shift;
+    unsigned int i;
+    int ret = 0;
+
+    x->batching = batch;
+    if (f->uploads)
+        ret = lcd_exec_upload(x, f);
+    if (!ret) {
+        lcd_plan_frame(plan, &f->shadow, x->ac, &x->cost);
+        lcd_plan_shift(plan, x->shift, f->shift, &x->cost);
+        if (batch && lcd_plan_is_slow(plan))
+            ret = -ENOSPC;
+    }
+    for (i = 0; i < plan->nops && !ret; i++)
+        ret = lcd_exec_op(x, &plan->ops[i], &f->shadow);
+    x->batching = 0;
+    if (batch) {
+        if (!ret)
+            return 0;
+        /* nothing went out, the solo path starts over */
+        lcd_stream_reset(&x->stream);
+        x->ac = ac;
+        x->shift = shift;
+        return -EAGAIN;
+    }
+    if (!ret)
+        ret = lcd_exec_xfer(x);
+    lcd_exec_done(x, ret);
+    return ret;
+}
+
+void lcd_exec_done(struct lcd_exec *x, int ret) {
+    lcd_stream_reset(&x->stream);
+    x->ac = ret ? LCD_AC_UNKNOWN : x->plan.ac;
+    x->shift = ret ? LCD_SHIFT_UNKNOWN : x->plan.shift;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * Plan executor: puts the reset sequence and planned frames on the bus
+ *
+ * The driver, the simulator tests and the benchmark all talk to a
+ * controller the same way: the datasheet reset, the configuration, then
+ * frames of glyph uploads and planner ops, encoded into as few messages
+ * as the stream allows, with clear and home sent on their own and waited
+ * for. This is that sequence, once. Where the bytes go and how the waits
+ * are spent is up to the caller's ops: i2c_transfer() and usleep_range()
+ * in the kernel, the timed simulator on the host.
+ */
+#ifndef DRIVER_LCD1602_EXEC_H_
+#define DRIVER_LCD1602_EXEC_H_
+
+#include "driver/lcd1602.h"
+#include "driver/lcd1602_encode.h"
+#include "driver/lcd1602_glyph.h"
+#include "driver/lcd1602_planner.h"
+
+/* >40ms after Vcc rises to 2.7V */
+#define LCD_POWER_ON_US  50000
+
+struct lcd_exec_ops {
+    /* send len port bytes as one write message, 0 or a negative errno */
+    int (*xfer)(void *ctx, const u8 *buf, unsigned int len);
+    /* sleep for at least us microseconds, us may be 0 */
+    void (*sleep_us)(void *ctx, unsigned int us);
+    /* wait for a clear or home to execute; NULL sleeps slow_cmd_us */
+    int (*wait_slow)(void *ctx);
+};
+
+/* what one flush puts on the glass */
+struct lcd_frame {
+    struct lcd_shadow shadow;   /* the cells, dirty ones are sent */
+    int shift;                  /* first visible DDRAM column wanted */
+    u8 uploads;                 /* CGRAM slots to send first */
+    u8 glyphs[LCD_CGRAM_SLOTS][LCD_GLYPH_ROWS];
+};
+
+struct lcd_exec {
+    const struct lcd_exec_ops *ops;
+    void *ctx;
+    const struct lcd_timing *timing;
+    struct lcd_stream stream;   /* pending port bytes */
+    struct lcd_cost_model cost;
+    struct lcd_plan plan;       /* of the last lcd_exec_flush() */
+    int batching;               /* lcd_exec_emit() must not send */
+    int ac;                     /* DDRAM address counter or LCD_AC_UNKNOWN */
+    int shift;                  /* display shift or LCD_SHIFT_UNKNOWN */
+};
+
+/* stream and cost model for the encoder and the bus clock of timing */
+void lcd_exec_init(struct lcd_exec *x, const struct lcd_exec_ops *ops,
+                   void *ctx, const struct lcd_encoder *enc,
+                   const struct lcd_timing *timing);
+
+/* send the pending port bytes, if any, as one message */
+int lcd_exec_xfer(struct lcd_exec *x);
+
+/*
+ * Queue one byte, sending the stream first if it is full; -ENOSPC
+ * instead while batching, a batched frame has to fit a single message.
+ */
+int lcd_exec_emit(struct lcd_exec *x, u8 val, u8 rs);
+
+/* a command, clear and home are sent right away and waited for */
+int lcd_exec_command(struct lcd_exec *x, u8 cmd);
+
+/*
+ * Datasheet reset by instruction (fig. 24) from power-on: the power-on
+ * wait, 0x3 three times, then 0x2 for the 4-bit interface.
+ */
+int lcd_exec_reset(struct lcd_exec *x);
+
+/*
+ * 4-bit, 2 lines, display on, cleared, left to right. On success the
+ * address counter and the shift are known to be 0, unknown otherwise.
+ */
+int lcd_exec_configure(struct lcd_exec *x);
+
+/*
+ * Push a frame to the glass: its glyphs first, then the dirty cells,
+ * then the move of the visible window, the way the planner finds
+ * cheapest.
+ *
+ * With batch set the frame is only encoded, and left in the stream for
+ * the caller to send along with other displays; -EAGAIN, with nothing
+ * emitted, when it needs a clear or home or does not fit one message.
+ * lcd_exec_done() then records the outcome of that transfer.
+ */
+int lcd_exec_flush(struct lcd_exec *x, const struct lcd_frame *f, int batch);
+
+/* where the frame left the controller, once its bytes are sent or lost */
+void lcd_exec_done(struct lcd_exec *x, int ret);
+
+#endif  // DRIVER_LCD1602_EXEC_H_
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * CGRAM glyph cache, see lcd1602_glyph.h
+ */
+
+#include "driver/lcd1602_glyph.h"
+
+/* FNV-1a over the 8 rows, only the low 5 bits of a row are pixels */
+static u32 lcd_glyph_hash(const u8 *bitmap) {
+    u32 h = 2166136261U;
+    unsigned int i;
+
+    for (i = 0; i < LCD_GLYPH_ROWS; i++) {
+        h ^= bitmap[i] & 0x1F;
+        h *= 16777619U;
+    }
+    return h;
+}
+
+static int lcd_glyph_equal(const u8 *a, const u8 *b) {
+    unsigned int i;
+
+    for (i = 0; i < LCD_GLYPH_ROWS; i++)
+        if ((a[i] ^ b[i]) & 0x1F)
+            return 0;
+    return 1;
+}
+
+void lcd_glyph_cache_init(struct lcd_glyph_cache *gc) {
+    unsigned int i;
+
+    for (i = 0; i < LCD_CGRAM_SLOTS; i++) {
+        gc->slots[i].valid = 0;
+        gc->slots[i].pinned = 0;
+        gc->slots[i].reserved = 0;
+        gc->slots[i].last_used = 0;
+    }
+    gc->clock = 0;
+    gc->upload = 0;
+}
+
+u8 lcd_glyph_in_use(const u8 *cells, unsigned int n) {
+    unsigned int i;
+    u8 mask = 0;
+
+    for (i = 0; i < n; i++)
+        if (cells[i] < 2 * LCD_CGRAM_SLOTS)
+            mask |= 1U << (cells[i] % LCD_CGRAM_SLOTS);
+    return mask;
+}
+
+/* load bitmap into a slot and queue its upload */
+static void lcd_glyph_load(struct lcd_glyph_cache *gc, int slot,
+                           const u8 *bitmap, u32 hash) {
+    struct lcd_glyph_slot *s = &gc->slots[slot];
+    unsigned int i;
+
+    for (i = 0; i < LCD_GLYPH_ROWS; i++)
+        s->bitmap[i] = bitmap[i] & 0x1F;
+    s->hash = hash;
+    s->valid = 1;
+    s->last_used = gc->clock;
+    gc->upload |= 1U << slot;
+}
+
+/* never-written slot first, then the least recently used free one */
+static int lcd_glyph_victim(const struct lcd_glyph_cache *gc, u8 in_use) {
+    const struct lcd_glyph_slot *s;
+    int i, victim = -1;
+
+    for (i = 0; i < LCD_CGRAM_SLOTS; i++) {
+        s = &gc->slots[i];
+        if (s->pinned || s->reserved || (in_use & (1U << i)))
+            continue;
+        if (!s->valid)
+            return i;
+        if (victim < 0 || s->last_used < gc->slots[victim].last_used)
+            victim = i;
+    }
+    return victim < 0 ? -ENOSPC : victim;
+}
+
+static void lcd_glyph_touch(struct lcd_glyph_cache *gc, u8 in_use) {
+    int i;
+
+    gc->clock++;
+    for (i = 0; i < LCD_CGRAM_SLOTS; i++)
+        if (in_use & (1U << i))
+            gc->slots[i].last_used = gc->clock;
+}
+
+int lcd_glyph_get(struct lcd_glyph_cache *gc, const u8 *bitmap, u8 in_use) {
+    struct lcd_glyph_slot *s;
+    u32 hash = lcd_glyph_hash(bitmap);
+    int i, victim;
+
+    lcd_glyph_touch(gc, in_use);
+    for (i = 0; i < LCD_CGRAM_SLOTS; i++) {
+        s = &gc->slots[i];
+        if (s->valid && !s->reserved && s->hash == hash &&
+            lcd_glyph_equal(s->bitmap, bitmap)) {
+            s->last_used = gc->clock;
+            return i;
+        }
+    }
+
+    victim = lcd_glyph_victim(gc, in_use);
+    if (victim >= 0)
+        lcd_glyph_load(gc, victim, bitmap, hash);
+    return victim;
+}
+
+int lcd_glyph_pin(struct lcd_glyph_cache *gc, const u8 *bitmap, u8 in_use) {
+    int slot = lcd_glyph_get(gc, bitmap, in_use);
+
+    if (slot >= 0)
+        gc->slots[slot].pinned = 1;
+    return slot;
+}
+
+int lcd_glyph_reserve(struct lcd_glyph_cache *gc, const u8 *bitmap, u8 in_use) {
+    int slot;
+
+    lcd_glyph_touch(gc, in_use);
+    slot = lcd_glyph_victim(gc, in_use);
+    if (slot < 0)
+        return slot;
+    lcd_glyph_load(gc, slot, bitmap, lcd_glyph_hash(bitmap));
+    gc->slots[slot].reserved = 1;
+    return slot;
+}
+
+void lcd_glyph_set(struct lcd_glyph_cache *gc, int slot, const u8 *bitmap) {
+    struct lcd_glyph_slot *s = &gc->slots[slot];
+
+    if (lcd_glyph_equal(s->bitmap, bitmap))
+        return;
+    lcd_glyph_load(gc, slot, bitmap, lcd_glyph_hash(bitmap));
+}
+
+void lcd_glyph_release(struct lcd_glyph_cache *gc, int slot) {
+    gc->slots[slot].reserved = 0;
+    gc->slots[slot].pinned = 0;
+    gc->slots[slot].last_used = gc->clock;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * CGRAM glyph cache for the 8 custom-character slots of the HD44780
+ *
+ * Glyphs are looked up by their 5x8 bitmap. A bitmap that is already in
+ * CGRAM, even one whose slot has been given up, is reused without an
+ * upload; an upload costs a Set-CGRAM command plus 8 rows. New glyphs go
+ * to a slot that has never been written first, then replace the glyph
+ * least recently displayed. Slots whose code is on the glass right now,
+ * or that are pinned, are never replaced, since that would change the
+ * cells showing them.
+ *
+ * A slot can also be reserved by one owner, e.g. an animation, which then
+ * rewrites its bitmap in place: every cell showing the code changes at
+ * once without any DDRAM traffic. Lookups never share a reserved slot,
+ * so a bitmap that happens to match the current frame is not dragged
+ * into the animation.
+ *
+ * Codes 0-7 and 8-15 show the same slot.
+ */
+#ifndef DRIVER_LCD1602_GLYPH_H_
+#define DRIVER_LCD1602_GLYPH_H_
+
+#include "driver/lcd1602.h"
+
+#define LCD_CGRAM_SLOTS  8
+#define LCD_GLYPH_ROWS   8
+
+struct lcd_glyph_slot {
+    u8 bitmap[LCD_GLYPH_ROWS];
+    u32 hash;
+    u32 last_used;      /* cache clock when last looked up or displayed */
+    u8 valid;           /* bitmap is what the slot holds (or will) */
+    u8 pinned;          /* never replaced */
+    u8 reserved;        /* owned via lcd_glyph_reserve(), implies pinned */
+};
+
+struct lcd_glyph_cache {
+    struct lcd_glyph_slot slots[LCD_CGRAM_SLOTS];
+    u32 clock;
+    u8 upload;          /* bit n: slot n has to be sent to CGRAM */
+};
+
+void lcd_glyph_cache_init(struct lcd_glyph_cache *gc);
+
+/* bit n set if slot n is shown by any of the cells */
+u8 lcd_glyph_in_use(const u8 *cells, unsigned int n);
+
+/*
+ * Slot holding bitmap, allocating (and marking for upload) if needed.
+ * in_use is lcd_glyph_in_use() of everything in DDRAM. Returns the slot
+ * or -ENOSPC when every slot is shown or pinned.
+ */
+int lcd_glyph_get(struct lcd_glyph_cache *gc, const u8 *bitmap, u8 in_use);
+
+/* lcd_glyph_get() and pin the slot, for glyphs that stay for good */
+int lcd_glyph_pin(struct lcd_glyph_cache *gc, const u8 *bitmap, u8 in_use);
+
+/*
+ * Take a slot for exclusive use, loaded with bitmap. Returns the slot or
+ * -ENOSPC, like lcd_glyph_get().
+ */
+int lcd_glyph_reserve(struct lcd_glyph_cache *gc, const u8 *bitmap, u8 in_use);
+
+/* rewrite a reserved slot, marking it for upload if the bitmap changed */
+void lcd_glyph_set(struct lcd_glyph_cache *gc, int slot, const u8 *bitmap);
+
+/* hand a reserved or pinned slot back to the cache, its bitmap stays resident */
+void lcd_glyph_release(struct lcd_glyph_cache *gc, int slot);
+
+#endif  // DRIVER_LCD1602_GLYPH_H_
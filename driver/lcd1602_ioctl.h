@@ -0,0 +1,153 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * lcd1602_ioctl.h - userspace interface of the lcd1602 misc device
+ *
+ * Besides write(), the display's shadow DDRAM can be mmap()ed: one page
+ * starting with struct lcd1602_shm. Userspace stores characters straight
+ * into ddram[][], sets the matching dirty bits with an atomic OR, e.g.
+ *
+ *   shm->ddram[row][col] = c;
+ *   __atomic_fetch_or(&shm->dirty[LCD1602_DIRTY_WORD(row, col)],
+ *                     LCD1602_DIRTY_BIT(col), __ATOMIC_RELEASE);
+ *
+ * and rings LCD1602_IOC_FLUSH. The driver takes the dirty bits with an
+ * atomic exchange, so marking never races with a flush, and bumps
+ * generation each time a frame has reached the glass.
+ */
+#ifndef DRIVER_LCD1602_IOCTL_H_
+#define DRIVER_LCD1602_IOCTL_H_
+
+#include <linux/ioctl.h>
+#include <linux/types.h>
+
+#define LCD1602_ROWS        2
+#define LCD1602_DDRAM_COLS  40   /* per row, the first 16 are visible */
+#define LCD1602_COLS        16
+#define LCD1602_PAGES       (LCD1602_DDRAM_COLS / LCD1602_COLS)
+
+/* 32-bit words so that every architecture can update them atomically */
+#define LCD1602_DIRTY_WORDS_PER_ROW  2
+#define LCD1602_DIRTY_WORD(row, col) \
+    ((row) * LCD1602_DIRTY_WORDS_PER_ROW + (col) / 32)
+#define LCD1602_DIRTY_BIT(col)  (1U << ((col) % 32))
+
+struct lcd1602_shm {
+    __u32 generation;   /* frames that reached the glass, driver-owned */
+    __u32 reserved;
+    __u32 dirty[LCD1602_ROWS * LCD1602_DIRTY_WORDS_PER_ROW];
+    __u8 ddram[LCD1602_ROWS][LCD1602_DDRAM_COLS];  /* row 1 = DDRAM 0x40 */
+};
+
+#define LCD1602_IOC_MAGIC 0x16
+
+/* doorbell: flush the cells marked dirty in the mmap()ed page */
+#define LCD1602_IOC_FLUSH  _IO(LCD1602_IOC_MAGIC, 1)
+
+/*
+ * Page flipping: DDRAM holds LCD1602_PAGES screens side by side, page n
+ * in columns n*16..n*16+15. DRAW_PAGE makes later write()s on this file
+ * go to page n, hidden or not; SHOW_PAGE moves the visible window there
+ * with display shift commands, without resending any characters.
+ */
+#define LCD1602_IOC_DRAW_PAGE  _IOW(LCD1602_IOC_MAGIC, 2, int)
+#define LCD1602_IOC_SHOW_PAGE  _IOW(LCD1602_IOC_MAGIC, 3, int)
+
+/*
+ * Marquee: text is loaded into the full 40 DDRAM columns of both rows
+ * once, then the driver shifts the display one column left every
+ * period_ms, one command per step. The shift moves both rows together,
+ * so the marquee owns the whole screen; SHOW_PAGE or a period_ms of 0
+ * stops it where it is. A marquee belongs to the file that started it:
+ * other files get EPERM from MARQUEE and SHOW_PAGE while it runs, and
+ * closing the file stops it. EINVAL for a period_ms below 20, or below
+ * what one shift takes on a slow bus.
+ */
+struct lcd1602_marquee {
+    __u32 period_ms;
+    __u8 text[LCD1602_ROWS][LCD1602_DDRAM_COLS];
+};
+
+#define LCD1602_IOC_MARQUEE  _IOW(LCD1602_IOC_MAGIC, 4, struct lcd1602_marquee)
+
+/*
+ * Custom characters: hand in a 5x8 bitmap (low 5 bits of each row, top
+ * row first) and get back the character code (0-7) to write into cells.
+ * The driver keeps the 8 CGRAM slots as a cache: a bitmap already resident
+ * costs nothing, otherwise the glyph not displayed for the longest time is
+ * replaced. EBUSY when all 8 slots are on the glass. Slots taken by
+ * animations, and the 3 of big digits once LCD1602_IOC_BIG has been used,
+ * are not part of the cache.
+ */
+struct lcd1602_glyph {
+    __u8 bitmap[8];
+    __u8 code;      /* out */
+};
+
+#define LCD1602_IOC_GLYPH  _IOWR(LCD1602_IOC_MAGIC, 5, struct lcd1602_glyph)
+
+/*
+ * Animated glyphs: nframes bitmaps played in a loop, one every period_ms,
+ * by rewriting the 8 rows of a CGRAM slot that is kept for the animation.
+ * Every cell holding the returned code changes together, at a cost of 9
+ * bus writes per frame however many cells that is. ANIM_STOP with the
+ * code ends the animation on its current frame and frees the slot. An
+ * animation belongs to the file that started it: other files get EPERM
+ * from ANIM_STOP, and closing the file stops it.
+ */
+#define LCD1602_ANIM_FRAMES  8
+
+struct lcd1602_anim {
+    __u32 period_ms;
+    __u8 nframes;   /* 1..LCD1602_ANIM_FRAMES */
+    __u8 code;      /* out */
+    __u8 frames[LCD1602_ANIM_FRAMES][8];
+    __u8 reserved[2];   /* must be 0 */
+};
+
+#define LCD1602_IOC_ANIM       _IOWR(LCD1602_IOC_MAGIC, 6, struct lcd1602_anim)
+#define LCD1602_IOC_ANIM_STOP  _IOW(LCD1602_IOC_MAGIC, 7, int)
+
+/*
+ * Bar graph: width cells from col on row of this file's draw page, filled
+ * to value out of max in 5 steps per cell (80 on a full row). Only the
+ * cells whose fill changed are sent, normally the one or two at the end
+ * of the bar. Uses one CGRAM slot while a bar ends in a partial cell;
+ * EBUSY if none is free.
+ */
+struct lcd1602_bar {
+    __u8 row;
+    __u8 col;
+    __u8 width;
+    __u8 reserved;
+    __u32 value;
+    __u32 max;
+};
+
+#define LCD1602_IOC_BAR  _IOW(LCD1602_IOC_MAGIC, 8, struct lcd1602_bar)
+
+/*
+ * Big digits: text of '0'-'9', ':' and ' ' drawn two rows tall from col
+ * of this file's draw page to its right edge. Digits are 3 columns wide
+ * and one apart, ':' one column, so "12:34" fits from col 0 or 1. The
+ * three glyphs they are built from take 3 CGRAM slots on first use, EBUSY
+ * if they are not free, and keep them until the panel goes away. Only
+ * changed cells are sent: a clock going from 12:34 to 12:35
+ * rewrites the cells of the last digit.
+ */
+struct lcd1602_big {
+    __u8 col;
+    __u8 len;
+    __u8 text[LCD1602_COLS];
+};
+
+#define LCD1602_IOC_BIG  _IOW(LCD1602_IOC_MAGIC, 9, struct lcd1602_big)
+
+/*
+ * poll(): EPOLLOUT while no frame waits to be flushed, EPOLLERR while the
+ * last flush failed, and EPOLLPRI once a frame has reached the glass that
+ * this file has not acknowledged yet. poll() itself only reports, EPOLLPRI
+ * stays set until the file calls ACK, or fsync() returns 0.
+ */
+#define LCD1602_IOC_ACK  _IO(LCD1602_IOC_MAGIC, 10)
+
+#endif  // DRIVER_LCD1602_IOCTL_H_
@@ -5,7 +5,8 @@
 set -e
 
 MODULE_NAME="lcd1602"
-DEVICE_NAME="lcd1602"
+# one node per panel: /dev/lcd1602-<bus>-<addr>, e.g. /dev/lcd1602-1-27
+DEVICE_GLOB="/dev/lcd1602-*"
 
 echo "Building ${MODULE_NAME} module..."
 make clean
@@ -14,17 +15,17 @@ make
 echo "Loading ${MODULE_NAME} module..."
 
 # Remove the module if already loaded
-if lsmod | grep -q "${MODULE_NAME}"; then
+if lsmod | grep -q "^${MODULE_NAME} "; then
     echo "Removing existing ${MODULE_NAME} module..."
     sudo rmmod "${MODULE_NAME}"
 fi
 
-# Install the module
+# Install the module, extra arguments are module parameters (e.g. pinmap=...)
 echo "Installing ${MODULE_NAME} module..."
-sudo insmod "./${MODULE_NAME}.ko"
+sudo insmod "./${MODULE_NAME}.ko" "$@"
 
 # Verify the module is loaded
-if lsmod | grep -q "${MODULE_NAME}"; then
+if lsmod | grep -q "^${MODULE_NAME} "; then
     echo "${MODULE_NAME} module loaded successfully!"
 else
     echo "Error: Failed to load ${MODULE_NAME} module"
@@ -34,7 +35,7 @@ fi
 # Display module information
 echo "==============================="
 echo "Module information:"
-lsmod | grep "${MODULE_NAME}"
+lsmod | grep "^${MODULE_NAME} "
 
 echo ""
 echo "Module parameters and sysfs entries:"
@@ -49,11 +50,11 @@ if [ -d "/sys/bus/i2c/devices" ]; then
 fi
 
 echo ""
-echo "Device file:"
-if [ -e "/dev/${DEVICE_NAME}" ]; then
-    ls -la "/dev/${DEVICE_NAME}"
+echo "Device files:"
+if compgen -G "${DEVICE_GLOB}" > /dev/null; then
+    ls -la ${DEVICE_GLOB}
 else
-    echo "/dev/${DEVICE_NAME} not found (may need to be created manually)"
+    echo "no ${DEVICE_GLOB} yet (is an lcd1602 i2c device instantiated?)"
 fi
 
 echo ""
@@ -0,0 +1,1662 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * I2C LCD1602 Driver - HD44780 LCD Controller via PCF8574 I2C Expander
+ *
+ * DATASHEET REFERENCES:
+ * - HD44780U (LCD Controller): https://en.wikipedia.org/wiki/Hitachi_HD44780
+ *   Official: https://www.alldatasheet.com/datasheet-pdf/pdf/50623/HITACHI/HD44780U.html
+ * - PCF8574/PCF8574A (I2C I/O Expander): https://www.nxp.com/products/interfaces-and-connectivity/i2c/i2c-io-expanders/remote-8-bit-i2c-io-expander:PCF8574
+ *   Datasheet: https://www.nxp.com/docs/en/data-sheet/PCF8574_PCF8574A.pdf
+ *
+ * HARDWARE ARCHITECTURE:
+ * ┌─────────────┐         I2C            ┌──────────┐      Parallel        ┌──────────┐
+ * │             │      (2 wires)         │          │     (8 wires)        │          │
+ * │ Raspberry   │───SDA────────────────▶│ PCF8574T │────────────────────▶│ HD44780  │
+ * │     Pi      │───SCL────────────────▶│  I2C to  │  P7,P6,P5,P4 → D7-D4 │   LCD    │
+ * │             │                        │  Parallel│  P2 → EN (Enable)    │Controller│
+ * │  (I2C       │      1 byte =          │ Expander │  P1 → RW             │          │
+ * │  Master)    │   8 bits control       │          │  P0 → RS (Register)  │ 16x2     │
+ * │             │   (Addr: 0x27)         │          │  P3 → BL (Backlight) │ Display  │
+ * └─────────────┘                        └──────────┘                      └──────────┘
+ *
+ * PCF8574 DATASHEET SUMMARY:
+ * - 8-bit quasi-bidirectional I/O expander
+ * - I2C slave address: 0x27 (PCF8574T) or 0x3F (PCF8574AT)
+ * - I2C speeds: 100kHz (Standard mode), 400kHz (Fast mode), 1MHz (Fast-plus)
+ * - Pin P0-P7: Weak internal pull-ups, suitable for open-drain outputs
+ * - Quasi-bidirectional mode: Acts as output with high-impedance input capability
+ * - Single byte I/O: Read/write entire 8-bit port in one I2C transaction
+ *
+ * HD44780 LCD CONTROLLER DATASHEET SUMMARY:
+ * - 16x2 character LCD (16 columns, 2 rows)
+ * - 4-bit or 8-bit parallel interface (we use 4-bit)
+ * - 4-bit mode: Data sent as two 4-bit nibbles (upper first, then lower)
+ * - Control pins: RS (Register Select), RW (Read/Write), EN (Enable)
+ * - EN pulse timing: High→Low transition latches data on falling edge
+ * - Minimum timing: EN pulse width ≥450ns, RS/RW setup ≥40ns before EN
+ *   rises, data setup ≥195ns before EN falls
+ * - Commands take 37-1530µs to execute (initialization needs delays)
+ * - 4-bit initialization sequence: Must send 0x30 three times, then 0x20
+ *
+ * TIMING PLAN:
+ * Every port byte is a whole I2C byte on the wire (9 clocks, 90µs at
+ * 100kHz), which covers the pulse and setup times many times over. What
+ * the bus does not cover of the execution times is worked out at probe
+ * from the bus clock (see lcd_timing_init()): idle pad bytes after each
+ * HD44780 byte where 37µs outlasts two port bytes (from 1MHz on), and
+ * sleeps for what is left of the clear/home and init waits between
+ * messages. The plan in use is in /sys/kernel/debug/lcd1602/<dev>/timing.
+ *
+ * PIN MAPPING (PCF8574 P0-P7 to HD44780):
+ * P0 = RS  (Register Select: 0=Command, 1=Data)
+ * P1 = RW  (Read/Write: 0=Write, 1=Read) - held at 0 unless busy_poll is set
+ * P2 = EN  (Enable: pulse high→low to latch data)
+ * P3 = BL  (Backlight: 1=On, 0=Off)
+ * P4 = D4  (Data bit 4)
+ * P5 = D5  (Data bit 5)
+ * P6 = D6  (Data bit 6)
+ * P7 = D7  (Data bit 7)
+ *
+ * Backpacks wired differently describe their layout with a "pin-map"
+ * property (or the pinmap module parameter) listing the P-pins of RS, RW,
+ * EN, BL, D4, D5, D6, D7, e.g. pin-map = <6 5 4 7 0 1 2 3>. It is compiled
+ * into the encode tables at probe, so any wiring costs the same per byte.
+ *
+ * 4-BIT MODE OPERATION (from HD44780 datasheet page 45-46):
+ * 1. Send upper 4 bits (D7-D4) of data/command to LCD via PCF8574 P7-P4
+ * 2. Pulse EN pin (set EN=1, then EN=0 in the next port byte)
+ * 3. Send lower 4 bits (D7-D4) of data/command to LCD via PCF8574 P7-P4
+ * 4. Pulse EN pin again
+ * Note: Bits D3-D0 are ignored in 4-bit mode
+ *
+ * BUSY FLAG READ (busy_poll=1):
+ * With RW=1 the HD44780 drives D7-D4 while EN is high. The PCF8574 pins are
+ * quasi-bidirectional, so after writing 1s to P4-P7 a port read returns the
+ * levels the controller drives: BF on P7 and AC6-AC4 on P6-P4, then AC3-AC0
+ * on the second EN pulse. Both nibbles must be clocked out.
+ */
+
+#include <linux/i2c.h>
+#include <linux/module.h>
+#include <linux/delay.h>
+#include <linux/miscdevice.h>
+#include <linux/fs.h>
+#include <linux/uaccess.h>
+#include <linux/mutex.h>
+#include <linux/spinlock.h>
+#include <linux/kref.h>
+#include <linux/ktime.h>
+#include <linux/property.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/of.h>
+#include <linux/string.h>
+#include <linux/workqueue.h>
+#include <linux/wait.h>
+#include <linux/poll.h>
+#include <linux/slab.h>
+#include <linux/mm.h>
+#include <linux/hrtimer.h>
+#include <linux/atomic.h>
+#include <linux/bitops.h>
+#include <linux/list.h>
+#include <linux/kthread.h>
+#include <linux/cpumask.h>
+#include <linux/err.h>
+#include "driver/lcd1602.h"
+#include "driver/lcd1602_encode.h"
+#include "driver/lcd1602_planner.h"
+#include "driver/lcd1602_exec.h"
+#include "driver/lcd1602_glyph.h"
+#include "driver/lcd1602_widget.h"
+#include "driver/lcd1602_ioctl.h"
+
+/* from product-manual CL Default I2C bus address:
+0x3F for the PCF8574AT chip, 0x27 for the PCF8574T  */
+#define LCD_I2C_ADDR 0x27
+
+/* give up polling the busy flag after this, clear takes 1.52ms */
+#define LCD_BUSY_TIMEOUT_US 10000
+
+/* assumed when neither the device nor its adapter says otherwise */
+#define LCD_BUS_HZ_DEFAULT  100000
+
+
+/* a CGRAM slot being animated, frames, active and owner are under lcd->lock */
+struct lcd_anim {
+    struct lcd1602_data *lcd;
+    struct lcd1602_file *owner; /* started it, the only one to stop it */
+    struct hrtimer timer;
+    ktime_t period;
+    atomic_t steps;             /* timer ticks not played yet */
+    bool active;
+    u8 nframes;
+    u8 frame;
+    u8 frames[LCD1602_ANIM_FRAMES][LCD_GLYPH_ROWS];
+};
+
+/* most displays one adapter can carry: PCF8574 0x20-0x27, PCF8574A 0x38-0x3f */
+#define LCD_BUS_BATCH  16
+
+/* the glass takes longer than this to follow a shift anyway */
+#define LCD_MARQUEE_MIN_MS  20
+
+/* a failed frame is retried after this, doubling up to the maximum */
+#define LCD_RETRY_MIN_MS  20
+#define LCD_RETRY_MAX_MS  2000
+
+/*
+Displays sharing an adapter are flushed by one scheduler, which sends the
+frames of all of them in a single i2c_transfer(), one message per address,
+so the adapter lock and the transfer setup are paid once per round. The
+member list is rotated after every round: with more displays pending than
+fit a round, each gets its turn. Every adapter has a kthread of its own,
+optionally bound to a CPU with bus_cpu, so separate buses flush in
+parallel rather than queueing behind each other. Adapters whose quirks
+forbid several messages per transfer get rounds of one.
+*/
+struct lcd_bus {
+    struct list_head node;      /* in lcd_buses */
+    struct i2c_adapter *adapter;
+    unsigned int users;         /* under lcd_buses_lock */
+    struct mutex lock;          /* members, and their streams during a round */
+    struct list_head members;
+    struct kthread_worker *worker;
+    struct kthread_work work;
+    unsigned int batch_max;     /* messages per transfer, from the quirks */
+};
+
+struct lcd1602_data {
+    struct kref ref;            /* probe's, plus one per open file */
+    struct i2c_client *client;
+    u8 backlight;
+    struct miscdevice miscdev;
+    char name[24];              /* lcd1602-<bus>-<addr>, the device node */
+    struct mutex lock;          /* never held across I2C */
+    bool gone;                  /* remove() started, under lock and kick_lock */
+    spinlock_t kick_lock;       /* lcd_kick() against remove() */
+    struct lcd1602_shm *shm;    /* shadow DDRAM, shared with mmap() users */
+    struct lcd_bus *bus;        /* scheduler of the adapter */
+    struct list_head bus_node;  /* in bus->members, under bus->lock */
+    unsigned long flush_pending;    /* bit 0: frame waiting for the scheduler */
+    struct work_struct init_work;   /* probe returns before the display is up */
+
+    /* frame sequence numbers, written under lock */
+    u32 commit_seq;             /* bumped by every write that changed a cell */
+    u32 glass_seq;              /* commit_seq of the last frame on the glass */
+    u32 flush_runs;             /* completed flushes, for error reporting */
+    int flush_err;              /* result of the last flush */
+    int want_shift;             /* first visible DDRAM column, under lock */
+
+    /* failed frames are resent by the timer, with backoff */
+    struct hrtimer retry_timer;
+    unsigned int retry_ms;      /* next delay, under lock */
+
+    /* marquee: the timer only counts steps, the flush worker shifts */
+    struct hrtimer marquee_timer;
+    ktime_t marquee_period;
+    ktime_t marquee_min;        /* shortest period, set at probe */
+    atomic_t marquee_steps;
+    struct lcd1602_file *marquee_owner; /* while it runs, under lock */
+
+    struct lcd_glyph_cache glyphs;  /* under lock */
+    struct lcd_anim anims[LCD_CGRAM_SLOTS];  /* indexed by slot */
+    u8 big_codes[LCD_BIG_GLYPHS];   /* pinned on first use, under lock */
+    bool big_pinned;
+    wait_queue_head_t flush_wq; /* woken after every flush */
+
+    /*
+    outcome of lcd_init_display(), published with release: the scheduler
+    reads them without bus_lock, which init holds through its waits
+    */
+    bool ready;                 /* lcd_init_display() succeeded */
+    int init_err;               /* its result, 0 while still pending */
+
+    /* everything below belongs to whoever holds bus_lock */
+    struct mutex bus_lock;
+    bool solo;                  /* last frame failed, send it on its own */
+    struct lcd_encoder enc;     /* port bytes for the wiring, set at probe */
+    struct lcd_exec exec;       /* stream, plan, address counter and shift */
+    struct lcd_frame frame;     /* snapshot of the shm being flushed */
+    bool busy_poll;             /* wait on BF instead of worst-case delays */
+    struct lcd_timing timing;
+    struct dentry *debugfs;
+};
+
+/* per-open state, for poll() */
+struct lcd1602_file {
+    struct lcd1602_data *lcd;
+    u32 seen_seq;               /* glass_seq last acknowledged, under lock */
+    unsigned int draw_page;     /* page write() goes to */
+};
+
+static struct dentry *lcd1602_debugfs;
+
+static LIST_HEAD(lcd_buses);
+static DEFINE_MUTEX(lcd_buses_lock);
+
+static bool busy_poll;
+module_param(busy_poll, bool, 0444);
+MODULE_PARM_DESC(busy_poll,
+                 "Poll the HD44780 busy flag over RW instead of fixed delays (RW must be wired)");
+
+#define LCD_MAX_ADAPTERS  16
+
+static int bus_cpu[LCD_MAX_ADAPTERS] = {
+    [0 ... LCD_MAX_ADAPTERS - 1] = -1,
+};
+static int bus_cpu_len;
+module_param_array(bus_cpu, int, &bus_cpu_len, 0444);
+MODULE_PARM_DESC(bus_cpu,
+                 "CPU to run the flush thread of i2c-N on, entry N, -1 for any (default any)");
+
+static unsigned int pinmap[LCD_PINMAP_LEN];
+static int pinmap_len;
+module_param_array(pinmap, uint, &pinmap_len, 0444);
+MODULE_PARM_DESC(pinmap,
+                 "P-pins of RS,RW,EN,BL,D4,D5,D6,D7 for backpacks without a pin-map property (default 0,1,2,3,4,5,6,7)");
+
+
+/*
+ask the adapter's scheduler to flush this display; timers and fops may
+still kick while remove() runs, the bus is only touched before it is gone
+*/
+static void lcd_kick(struct lcd1602_data *lcd) {
+    unsigned long flags;
+
+    set_bit(0, &lcd->flush_pending);
+    spin_lock_irqsave(&lcd->kick_lock, flags);
+    if (!lcd->gone)
+        kthread_queue_work(lcd->bus->worker, &lcd->bus->work);
+    spin_unlock_irqrestore(&lcd->kick_lock, flags);
+}
+
+/* open files keep the display's memory, not the display, past remove() */
+static void lcd_free(struct kref *ref) {
+    struct lcd1602_data *lcd = container_of(ref, struct lcd1602_data, ref);
+
+    free_page((unsigned long)lcd->shm);
+    kfree(lcd);
+}
+
+/* -ENODEV once remove() has started, the first check of every fop */
+static int lcd_check_gone(struct lcd1602_data *lcd) {
+    int ret;
+
+    mutex_lock(&lcd->lock);
+    ret = lcd->gone ? -ENODEV : 0;
+    mutex_unlock(&lcd->lock);
+    return ret;
+}
+
+/*
+send port bytes as a single write transaction,
+the PCF8574 latches them onto P0-P7 one after the other
+*/
+static int lcd_xfer(void *ctx, const u8 *buf, unsigned int len) {
+    struct lcd1602_data *lcd = ctx;
+    struct i2c_msg msg = {
+        .addr = lcd->client->addr,
+        .flags = 0,
+        .len = len,
+        .buf = (u8 *)buf,
+    };
+    int ret;
+
+    ret = i2c_transfer(lcd->client->adapter, &msg, 1);
+    if (ret < 0)
+        return ret;
+    return ret == 1 ? 0 : -EIO;
+}
+
+/*
+sleep for whatever part of a wait the bus did not already cover,
+the power-on wait is long enough for msleep()
+*/
+static void lcd_sleep_us(unsigned int us) {
+    if (us >= 20000)
+        msleep(DIV_ROUND_UP(us, 1000));
+    else if (us)
+        usleep_range(us, us + us / 4);
+}
+
+/*
+read the busy flag and address counter, one combined transaction:
+EN high, read D7-D4, EN low, EN high, read D3-D0, EN low.
+Adapters whose quirks rule that out get the same messages one transfer
+each; the expander holds its outputs across the stops, so EN stays high
+in between just the same.
+*/
+static int lcd_read_bf_ac(struct lcd1602_data *lcd, u8 *bf_ac) {
+    const struct i2c_adapter_quirks *q = lcd->client->adapter->quirks;
+    u8 port = lcd->enc.read_port;
+    u8 en_hi[2] = { port, port | lcd->enc.en };
+    u8 en_hi2[2] = { port, port | lcd->enc.en };
+    u8 en_lo[1] = { port };
+    u8 hi, lo;
+    struct i2c_msg msgs[] = {
+        { .addr = lcd->client->addr, .len = sizeof(en_hi), .buf = en_hi },
+        { .addr = lcd->client->addr, .flags = I2C_M_RD, .len = 1, .buf = &hi },
+        { .addr = lcd->client->addr, .len = sizeof(en_hi2), .buf = en_hi2 },
+        { .addr = lcd->client->addr, .flags = I2C_M_RD, .len = 1, .buf = &lo },
+        { .addr = lcd->client->addr, .len = sizeof(en_lo), .buf = en_lo },
+    };
+    int i, ret, step = ARRAY_SIZE(msgs);
+
+    if (q && ((q->flags & (I2C_AQ_NO_COMB | I2C_AQ_COMB)) ||
+              (q->max_num_msgs && q->max_num_msgs < step)))
+        step = 1;
+    for (i = 0; i < ARRAY_SIZE(msgs); i += step) {
+        ret = i2c_transfer(lcd->client->adapter, &msgs[i], step);
+        if (ret < 0)
+            return ret;
+        if (ret != step)
+            return -EIO;
+    }
+    *bf_ac = lcd_encoder_decode(&lcd->enc, hi) << 4 |
+             lcd_encoder_decode(&lcd->enc, lo);
+    return 0;
+}
+
+/*
+wait until the controller is ready, by polling BF when enabled and
+by sleeping for the worst case otherwise. A flag that never clears means
+RW is not wired, so polling is turned off for good.
+*/
+static int lcd_wait_ready(struct lcd1602_data *lcd) {
+    ktime_t timeout;
+    u8 bf_ac;
+    int ret;
+
+    if (!lcd->busy_poll) {
+        lcd_sleep_us(lcd->timing.slow_cmd_us);
+        return 0;
+    }
+
+    timeout = ktime_add_us(ktime_get(), LCD_BUSY_TIMEOUT_US);
+    do {
+        ret = lcd_read_bf_ac(lcd, &bf_ac);
+        if (ret)
+            return ret;
+        if (!(bf_ac & 0x80))
+            return 0;
+    } while (ktime_before(ktime_get(), timeout));
+
+    dev_warn(&lcd->client->dev,
+             "busy flag stuck, RW not wired? falling back to fixed delays\n");
+    lcd->busy_poll = false;
+    lcd_sleep_us(lcd->timing.slow_cmd_us);
+    return 0;
+}
+
+/* the bus side of lcd_exec, ctx is the lcd1602_data */
+static void lcd_ops_sleep_us(void *ctx, unsigned int us) {
+    lcd_sleep_us(us);
+}
+
+static int lcd_ops_wait_slow(void *ctx) {
+    return lcd_wait_ready(ctx);
+}
+
+static const struct lcd_exec_ops lcd_exec_ops = {
+    .xfer = lcd_xfer,
+    .sleep_us = lcd_ops_sleep_us,
+    .wait_slow = lcd_ops_wait_slow,
+};
+
+static void lcd_shm_mark_written(struct lcd1602_shm *shm);
+
+/*
+check whether the controller is already in 4-bit 2-line mode, e.g. after a
+module reload or a bootloader splash: address 0x27 and move the cursor
+right, which lands on 0x40 only in 2-line mode. A controller in 8-bit mode
+or out of nibble sync garbles the commands and reads back something else.
+The read drives RW, so this needs busy_poll; without RW wired the released
+data pins would be written to the controller instead.
+*/
+static bool lcd_init_warm(struct lcd1602_data *lcd) {
+    int ret, tries = 3;
+    u8 bf_ac;
+
+    if (!lcd->busy_poll)
+        return false;
+    ret = lcd_stream_power_on(&lcd->exec.stream);
+    if (!ret)
+        ret = lcd_exec_command(&lcd->exec, LCD_SET_DDRAM | 0x27);
+    if (!ret)
+        ret = lcd_exec_command(&lcd->exec, LCD_CURSOR_SHIFT |
+                               LCD_CURSOR_MOVE | LCD_MOVE_RIGHT);
+    if (!ret)
+        ret = lcd_exec_xfer(&lcd->exec);
+    do {
+        if (!ret)
+            ret = lcd_read_bf_ac(lcd, &bf_ac);
+    } while (!ret && (bf_ac & 0x80) && --tries);
+    return !ret && bf_ac == LCD_ROW_ADDR(1);
+}
+
+/*
+init lcd in 4-bit mode, skipping the power-on wait and the reset
+sequence when the controller turns out to be configured already
+*/
+static int lcd_init_display(struct lcd1602_data *lcd) {
+    const struct i2c_adapter_quirks *quirks = lcd->client->adapter->quirks;
+    int ret = 0;
+
+    mutex_lock(&lcd->bus_lock);
+    lcd_stream_reset(&lcd->exec.stream);
+    if (quirks && quirks->max_write_len)
+        lcd_stream_limit(&lcd->exec.stream, quirks->max_write_len);
+
+    if (lcd_init_warm(lcd)) {
+        dev_dbg(&lcd->client->dev, "controller configured, warm init\n");
+    } else {
+        ret = lcd_exec_reset(&lcd->exec);
+        if (ret)
+            goto out;
+    }
+
+    /* the clear waits on BF when busy_poll is set */
+    ret = lcd_exec_configure(&lcd->exec);
+
+    /*
+    clear filled the whole DDRAM with spaces, anything written to the
+    shadow before init finished still has to go out
+    */
+    if (!ret)
+        lcd_shm_mark_written(lcd->shm);
+    smp_store_release(&lcd->ready, !ret);
+out:
+    mutex_unlock(&lcd->bus_lock);
+    return ret;
+}
+
+/*
+the dirty words are shared with userspace, which sets bits with atomic
+ORs of its own, so every update here has to be atomic as well
+*/
+static void lcd_shm_mark(struct lcd1602_shm *shm, unsigned int word, u32 bits) {
+    u32 old;
+
+    do {
+        old = READ_ONCE(shm->dirty[word]);
+    } while (cmpxchg(&shm->dirty[word], old, old | bits) != old);
+}
+
+/* store one cell in the shadow, marking it dirty only if it changed */
+static bool lcd_shadow_put(struct lcd1602_shm *shm, unsigned int row,
+                           unsigned int col, u8 c) {
+    if (shm->ddram[row][col] == c)
+        return false;
+    shm->ddram[row][col] = c;
+    lcd_shm_mark(shm, LCD1602_DIRTY_WORD(row, col), LCD1602_DIRTY_BIT(col));
+    return true;
+}
+
+/* take the dirty bits first, so any cell they cover is already stored */
+static void lcd_shm_snapshot(struct lcd1602_shm *shm, struct lcd_shadow *frame) {
+    unsigned int row, w;
+
+    for (row = 0; row < LCD_ROWS; row++) {
+        w = LCD1602_DIRTY_WORD(row, 0);
+        frame->dirty[row] = xchg(&shm->dirty[w], 0) |
+                            (u64)xchg(&shm->dirty[w + 1], 0) << 32;
+    }
+    memcpy(frame->ddram, shm->ddram, sizeof(frame->ddram));
+}
+
+/* mark every cell that is not a space, for a freshly cleared DDRAM */
+static void lcd_shm_mark_written(struct lcd1602_shm *shm) {
+    unsigned int row, col;
+
+    for (row = 0; row < LCD_ROWS; row++)
+        for (col = 0; col < LCD_DDRAM_COLS; col++)
+            if (READ_ONCE(shm->ddram[row][col]) != ' ')
+                lcd_shm_mark(shm, LCD1602_DIRTY_WORD(row, col),
+                             LCD1602_DIRTY_BIT(col));
+}
+
+static bool lcd_shm_dirty(const struct lcd1602_shm *shm) {
+    unsigned int i;
+
+    for (i = 0; i < ARRAY_SIZE(shm->dirty); i++)
+        if (READ_ONCE(shm->dirty[i]))
+            return true;
+    return false;
+}
+
+/*
+push the snapshot to the glass, see lcd_exec_flush(): with batch set the
+frame is left in the stream for the scheduler, lcd_exec_done() records
+the outcome of its transfer
+*/
+static int lcd_flush(struct lcd1602_data *lcd, bool batch) {
+    lockdep_assert_held(&lcd->bus_lock);
+    return lcd_exec_flush(&lcd->exec, &lcd->frame, batch);
+}
+
+/*
+play the animation frames the timers asked for; as with the marquee,
+ticks missed on a slow bus are skipped rather than played late
+*/
+static void lcd_anim_advance(struct lcd1602_data *lcd) {
+    struct lcd_anim *anim;
+    unsigned int slot;
+    int n;
+
+    lockdep_assert_held(&lcd->lock);
+    for (slot = 0; slot < LCD_CGRAM_SLOTS; slot++) {
+        anim = &lcd->anims[slot];
+        n = atomic_xchg(&anim->steps, 0);
+        if (!n || !anim->active)
+            continue;
+        anim->frame = (anim->frame + n) % anim->nframes;
+        lcd_glyph_set(&lcd->glyphs, slot, anim->frames[anim->frame]);
+        if (lcd->glyphs.upload & BIT(slot))
+            lcd->commit_seq++;
+    }
+}
+
+/*
+take a snapshot of the shm, with the glyphs to upload and the marquee
+steps, for lcd_flush(); returns the commit_seq it covers. Writes that
+land meanwhile just kick the scheduler again, so however many frames
+arrive in between only the latest one is transmitted, and writers only
+ever wait for the snapshot copy, never for the bus.
+*/
+static u32 lcd_frame_begin(struct lcd1602_data *lcd) {
+    unsigned int slot;
+    u32 seq;
+    int n;
+
+    lockdep_assert_held(&lcd->bus_lock);
+    mutex_lock(&lcd->lock);
+    lcd_shm_snapshot(lcd->shm, &lcd->frame.shadow);
+    lcd_anim_advance(lcd);
+    lcd->frame.uploads = lcd->glyphs.upload;
+    lcd->glyphs.upload = 0;
+    for (slot = 0; slot < LCD_CGRAM_SLOTS; slot++)
+        if (lcd->frame.uploads & BIT(slot))
+            memcpy(lcd->frame.glyphs[slot], lcd->glyphs.slots[slot].bitmap,
+                   LCD_GLYPH_ROWS);
+    n = atomic_xchg(&lcd->marquee_steps, 0);
+    if (n) {
+        /* a slow bus makes the marquee jump, never lag behind */
+        lcd->want_shift = (lcd->want_shift + n) % LCD_DDRAM_COLS;
+        lcd->commit_seq++;
+    }
+    lcd->frame.shift = lcd->want_shift;
+    seq = lcd->commit_seq;
+    mutex_unlock(&lcd->lock);
+    return seq;
+}
+
+/* hand the frame's cells and glyphs back to the shadow, to be sent again */
+static void lcd_frame_restore(struct lcd1602_data *lcd) {
+    unsigned int row, w;
+
+    lockdep_assert_held(&lcd->lock);
+    lcd->glyphs.upload |= lcd->frame.uploads;
+    for (row = 0; row < LCD_ROWS; row++) {
+        w = LCD1602_DIRTY_WORD(row, 0);
+        lcd_shm_mark(lcd->shm, w, (u32)lcd->frame.shadow.dirty[row]);
+        lcd_shm_mark(lcd->shm, w + 1,
+                     (u32)(lcd->frame.shadow.dirty[row] >> 32));
+    }
+}
+
+static enum hrtimer_restart lcd_retry_tick(struct hrtimer *timer) {
+    lcd_kick(container_of(timer, struct lcd1602_data, retry_timer));
+    return HRTIMER_NORESTART;
+}
+
+/*
+publish the outcome of the frame seq and wake fsync()/poll(); a failed
+frame is retried on its own after a backoff, so a panel that keeps
+NACKing neither spins the scheduler nor holds up the others' batches
+*/
+static void lcd_frame_end(struct lcd1602_data *lcd, u32 seq, int ret) {
+    lockdep_assert_held(&lcd->bus_lock);
+    lcd->solo = ret != 0;
+
+    mutex_lock(&lcd->lock);
+    if (ret) {
+        lcd_frame_restore(lcd);
+        if (!lcd->gone)
+            hrtimer_start(&lcd->retry_timer, ms_to_ktime(lcd->retry_ms),
+                          HRTIMER_MODE_REL);
+        lcd->retry_ms = min_t(unsigned int, 2 * lcd->retry_ms,
+                              LCD_RETRY_MAX_MS);
+    } else {
+        lcd->retry_ms = LCD_RETRY_MIN_MS;
+        lcd->glass_seq = seq;
+        WRITE_ONCE(lcd->shm->generation, lcd->shm->generation + 1);
+    }
+    lcd->flush_err = ret;
+    lcd->flush_runs++;
+    mutex_unlock(&lcd->lock);
+
+    if (ret)
+        dev_err_ratelimited(&lcd->client->dev, "flush failed: %d\n", ret);
+    wake_up_interruptible_poll(&lcd->flush_wq,
+                               ret ? EPOLLERR : EPOLLOUT | EPOLLPRI);
+}
+
+/*
+scheduler side of one display: take its frame and encode it. Returns true
+if the frame now waits in lcd->exec.stream for the round's transfer. Frames
+that cannot be batched are sent right here, on their own, and so is every
+frame of a display whose last one failed.
+*/
+static bool lcd_bus_prepare(struct lcd1602_data *lcd, u32 *seq) {
+    int ret;
+
+    /*
+    a display still in init is skipped without touching bus_lock, so the
+    power-on and reset waits never hold up the rest of the adapter; the
+    init worker kicks once it is done, report it if it failed
+    */
+    if (!smp_load_acquire(&lcd->ready)) {
+        ret = smp_load_acquire(&lcd->init_err);
+        if (ret) {
+            mutex_lock(&lcd->lock);
+            lcd->flush_err = ret;
+            lcd->flush_runs++;
+            mutex_unlock(&lcd->lock);
+            wake_up_interruptible_poll(&lcd->flush_wq, EPOLLERR);
+        }
+        return false;
+    }
+    mutex_lock(&lcd->bus_lock);
+    *seq = lcd_frame_begin(lcd);
+    ret = lcd_flush(lcd, !lcd->solo);
+    if (!ret && lcd->exec.stream.len) {
+        /* bus->lock keeps everyone else off the stream until the round ends */
+        mutex_unlock(&lcd->bus_lock);
+        return true;
+    }
+    if (ret == -EAGAIN)
+        ret = lcd_flush(lcd, false);
+    else
+        lcd_exec_done(&lcd->exec, ret);
+    lcd_frame_end(lcd, *seq, ret);
+    mutex_unlock(&lcd->bus_lock);
+    return false;
+}
+
+/*
+one scheduling round: every pending display of the adapter, up to
+batch_max of them, in a single i2c_transfer(). The controller's transfer
+stops at the first message that fails, and which one that was is not
+reported, so when a batch fails every frame in it is planned again and
+sent on its own in the next round; only that reports errors.
+*/
+static void lcd_bus_work(struct kthread_work *work) {
+    struct lcd_bus *bus = container_of(work, struct lcd_bus, work);
+    struct lcd1602_data *batch[LCD_BUS_BATCH], *lcd;
+    struct i2c_msg msgs[LCD_BUS_BATCH];
+    u32 seqs[LCD_BUS_BATCH];
+    unsigned int i, n = 0;
+    bool more = false;
+    int ret, err;
+
+    mutex_lock(&bus->lock);
+    list_for_each_entry(lcd, &bus->members, bus_node) {
+        if (!test_bit(0, &lcd->flush_pending))
+            continue;
+        if (n == bus->batch_max) {
+            more = true;
+            break;
+        }
+        clear_bit(0, &lcd->flush_pending);
+        if (!lcd_bus_prepare(lcd, &seqs[n]))
+            continue;
+        msgs[n] = (struct i2c_msg) {
+            .addr = lcd->client->addr,
+            .len = lcd->exec.stream.len,
+            .buf = lcd->exec.stream.buf,
+        };
+        batch[n++] = lcd;
+    }
+
+    ret = n ? i2c_transfer(bus->adapter, msgs, n) : 0;
+    for (i = 0; i < n; i++) {
+        if (ret < 0)
+            err = ret;
+        else
+            err = i < ret ? 0 : -EIO;
+        lcd = batch[i];
+        mutex_lock(&lcd->bus_lock);
+        lcd_exec_done(&lcd->exec, err);
+        if (err && n > 1) {
+            mutex_lock(&lcd->lock);
+            lcd_frame_restore(lcd);
+            mutex_unlock(&lcd->lock);
+            lcd->solo = true;
+            set_bit(0, &lcd->flush_pending);
+            more = true;
+        } else {
+            lcd_frame_end(lcd, seqs[i], err);
+        }
+        mutex_unlock(&lcd->bus_lock);
+    }
+
+    /* fairness: the next round starts one display further on */
+    if (!list_empty(&bus->members))
+        list_rotate_left(&bus->members);
+    mutex_unlock(&bus->lock);
+    if (more)
+        kthread_queue_work(bus->worker, &bus->work);
+}
+
+/* displays per round the adapter's quirks allow */
+static unsigned int lcd_bus_batch_max(struct i2c_adapter *adapter) {
+    const struct i2c_adapter_quirks *q = adapter->quirks;
+
+    if (!q)
+        return LCD_BUS_BATCH;
+    /* combined transfers are either forbidden or only write-then-read */
+    if (q->flags & (I2C_AQ_NO_COMB | I2C_AQ_COMB))
+        return 1;
+    if (q->max_num_msgs > 0 && q->max_num_msgs < LCD_BUS_BATCH)
+        return q->max_num_msgs;
+    return LCD_BUS_BATCH;
+}
+
+/* scheduler of the client's adapter, created by the first display on it */
+static struct lcd_bus *lcd_bus_get(struct i2c_adapter *adapter) {
+    struct lcd_bus *bus;
+    int nr;
+
+    mutex_lock(&lcd_buses_lock);
+    list_for_each_entry(bus, &lcd_buses, node) {
+        if (bus->adapter == adapter) {
+            bus->users++;
+            goto out;
+        }
+    }
+    bus = kzalloc(sizeof(*bus), GFP_KERNEL);
+    if (!bus)
+        goto out;
+    /* one round at a time per adapter, the frames go out in order */
+    nr = i2c_adapter_id(adapter);
+    if (nr < bus_cpu_len && bus_cpu[nr] >= 0 && cpu_online(bus_cpu[nr]))
+        bus->worker = kthread_create_worker_on_cpu(bus_cpu[nr], 0,
+                                                   "lcd1602-bus%d", nr);
+    else
+        bus->worker = kthread_create_worker(0, "lcd1602-bus%d", nr);
+    if (IS_ERR(bus->worker)) {
+        kfree(bus);
+        bus = NULL;
+        goto out;
+    }
+    bus->adapter = adapter;
+    bus->batch_max = lcd_bus_batch_max(adapter);
+    bus->users = 1;
+    mutex_init(&bus->lock);
+    INIT_LIST_HEAD(&bus->members);
+    kthread_init_work(&bus->work, lcd_bus_work);
+    list_add(&bus->node, &lcd_buses);
+out:
+    mutex_unlock(&lcd_buses_lock);
+    return bus;
+}
+
+static void lcd_bus_put(struct lcd_bus *bus) {
+    mutex_lock(&lcd_buses_lock);
+    if (--bus->users) {
+        mutex_unlock(&lcd_buses_lock);
+        return;
+    }
+    list_del(&bus->node);
+    mutex_unlock(&lcd_buses_lock);
+    kthread_destroy_worker(bus->worker);
+    kfree(bus);
+}
+
+static void lcd_bus_join(struct lcd1602_data *lcd) {
+    mutex_lock(&lcd->bus->lock);
+    list_add_tail(&lcd->bus_node, &lcd->bus->members);
+    mutex_unlock(&lcd->bus->lock);
+}
+
+/* once this returns the scheduler no longer touches the display */
+static void lcd_bus_leave(struct lcd1602_data *lcd) {
+    mutex_lock(&lcd->bus->lock);
+    list_del(&lcd->bus_node);
+    mutex_unlock(&lcd->bus->lock);
+}
+
+/*
+bring the display up off the probe path; writes made meanwhile are
+kept in the shadow and flushed, with their glyphs, right after
+*/
+static void lcd_init_work(struct work_struct *work) {
+    struct lcd1602_data *lcd = container_of(work, struct lcd1602_data,
+                                            init_work);
+    int ret;
+
+    ret = lcd_init_display(lcd);
+    if (ret < 0) {
+        dev_err(&lcd->client->dev, "Failed to initialize LCD: %d\n", ret);
+        smp_store_release(&lcd->init_err, ret);
+    }
+    lcd_kick(lcd);
+}
+
+/*
+write text to the draw page (the visible one unless changed by
+LCD1602_IOC_DRAW_PAGE), starting at the top-left cell,
+'\n' moves to the start of the next row, text that does not fit is dropped.
+Returns once the shadow is updated, only the cells whose character
+actually changed are later sent to the glass by the flush worker.
+*/
+static ssize_t lcd1602_write(struct file *filp, const char __user *buf,
+                             size_t count, loff_t *f_pos) {
+    struct lcd1602_file *f = filp->private_data;
+    struct lcd1602_data *lcd = f->lcd;
+    char text[LCD_ROWS * (LCD_COLS + 1)];
+    size_t len = min(count, sizeof(text));
+    unsigned int row = 0, col = 0;
+    unsigned int base = f->draw_page * LCD_COLS;
+    bool changed = false;
+    size_t i;
+
+    if (copy_from_user(text, buf, len))
+        return -EFAULT;
+
+    mutex_lock(&lcd->lock);
+    if (lcd->gone) {
+        mutex_unlock(&lcd->lock);
+        return -ENODEV;
+    }
+    for (i = 0; i < len; i++) {
+        if (text[i] == '\n') {
+            if (++row >= LCD_ROWS)
+                break;
+            col = 0;
+            continue;
+        }
+        if (col < LCD_COLS)
+            changed |= lcd_shadow_put(lcd->shm, row, base + col++, text[i]);
+    }
+    if (changed)
+        lcd->commit_seq++;
+    mutex_unlock(&lcd->lock);
+
+    if (changed)
+        lcd_kick(lcd);
+    return count;
+}
+
+static bool lcd_flushed(struct lcd1602_data *lcd, u32 seq, u32 runs) {
+    return (s32)(READ_ONCE(lcd->glass_seq) - seq) >= 0 ||
+           (READ_ONCE(lcd->flush_runs) != runs && READ_ONCE(lcd->flush_err));
+}
+
+/* fsync() that succeeded, or LCD1602_IOC_ACK: the glass has been seen */
+static void lcd_ack(struct lcd1602_file *f) {
+    mutex_lock(&f->lcd->lock);
+    f->seen_seq = f->lcd->glass_seq;
+    mutex_unlock(&f->lcd->lock);
+}
+
+/*
+wait until every frame written before the call is on the glass,
+kicking a flush in case an earlier one failed
+*/
+static int lcd1602_fsync(struct file *filp, loff_t start, loff_t end,
+                         int datasync) {
+    struct lcd1602_file *f = filp->private_data;
+    struct lcd1602_data *lcd = f->lcd;
+    u32 seq, runs;
+    int ret;
+
+    mutex_lock(&lcd->lock);
+    if (lcd->gone) {
+        mutex_unlock(&lcd->lock);
+        return -ENODEV;
+    }
+    seq = lcd->commit_seq;
+    runs = lcd->flush_runs;
+    mutex_unlock(&lcd->lock);
+
+    if ((s32)(READ_ONCE(lcd->glass_seq) - seq) < 0) {
+        lcd_kick(lcd);
+        ret = wait_event_interruptible(lcd->flush_wq,
+                                       lcd_flushed(lcd, seq, runs) ||
+                                       READ_ONCE(lcd->gone));
+        if (ret)
+            return ret;
+        if (READ_ONCE(lcd->gone))
+            return -ENODEV;
+        if ((s32)(READ_ONCE(lcd->glass_seq) - seq) < 0)
+            return lcd->flush_err;
+    }
+    lcd_ack(f);
+    return 0;
+}
+
+/*
+EPOLLOUT: no frame is waiting to be flushed
+EPOLLERR: the last flush failed, it is retried with backoff
+EPOLLPRI: a frame reached the glass that this file has not acknowledged
+EPOLLHUP: the display was removed
+poll only compares, see LCD1602_IOC_ACK
+*/
+static __poll_t lcd1602_poll(struct file *filp, poll_table *wait) {
+    struct lcd1602_file *f = filp->private_data;
+    struct lcd1602_data *lcd = f->lcd;
+    __poll_t mask = 0;
+
+    poll_wait(filp, &lcd->flush_wq, wait);
+
+    mutex_lock(&lcd->lock);
+    if (lcd->gone) {
+        mutex_unlock(&lcd->lock);
+        return EPOLLHUP | EPOLLERR;
+    }
+    if (lcd->glass_seq == lcd->commit_seq)
+        mask |= EPOLLOUT | EPOLLWRNORM;
+    if (lcd->flush_err)
+        mask |= EPOLLERR;
+    if (lcd->glass_seq != f->seen_seq)
+        mask |= EPOLLPRI;
+    mutex_unlock(&lcd->lock);
+    return mask;
+}
+
+static enum hrtimer_restart lcd_marquee_tick(struct hrtimer *timer) {
+    struct lcd1602_data *lcd = container_of(timer, struct lcd1602_data,
+                                            marquee_timer);
+
+    atomic_inc(&lcd->marquee_steps);
+    lcd_kick(lcd);
+    hrtimer_forward_now(timer, lcd->marquee_period);
+    return HRTIMER_RESTART;
+}
+
+/*
+stop the marquee if f started it, under lock; the tick never takes lock,
+so the timer is cancelled under it. -EPERM while another file's runs.
+*/
+static int lcd_marquee_stop(struct lcd1602_data *lcd,
+                            struct lcd1602_file *f) {
+    if (!lcd->marquee_owner)
+        return 0;
+    if (lcd->marquee_owner != f)
+        return -EPERM;
+    hrtimer_cancel(&lcd->marquee_timer);
+    atomic_set(&lcd->marquee_steps, 0);
+    lcd->marquee_owner = NULL;
+    return 0;
+}
+
+/*
+no faster than LCD_MARQUEE_MIN_MS, nor than a step can go out: one shift
+command in a message of its own, with its setup byte and the START/STOP
+and address the message costs
+*/
+static void lcd_marquee_init(struct lcd1602_data *lcd) {
+    u64 ns = (u64)(2 + 1 + lcd_stream_byte_cost(&lcd->exec.stream)) *
+             lcd->timing.byte_ns;
+
+    lcd->marquee_min = max_t(ktime_t, ms_to_ktime(LCD_MARQUEE_MIN_MS),
+                             ns_to_ktime(ns));
+}
+
+static int lcd_marquee_start(struct lcd1602_data *lcd, struct lcd1602_file *f,
+                             const struct lcd1602_marquee *mq) {
+    unsigned int row, col;
+    int ret;
+
+    if (mq->period_ms &&
+        ktime_before(ms_to_ktime(mq->period_ms), lcd->marquee_min))
+        return -EINVAL;
+
+    mutex_lock(&lcd->lock);
+    ret = lcd_marquee_stop(lcd, f);
+    if (ret) {
+        mutex_unlock(&lcd->lock);
+        return ret;
+    }
+    for (row = 0; row < LCD_ROWS; row++)
+        for (col = 0; col < LCD_DDRAM_COLS; col++)
+            lcd_shadow_put(lcd->shm, row, col, mq->text[row][col]);
+    lcd->want_shift = 0;
+    lcd->commit_seq++;
+    /* under lock, so remove() either sees the timer or stops us here */
+    if (mq->period_ms && !lcd->gone) {
+        lcd->marquee_period = ms_to_ktime(mq->period_ms);
+        lcd->marquee_owner = f;
+        hrtimer_start(&lcd->marquee_timer, lcd->marquee_period,
+                      HRTIMER_MODE_REL);
+    }
+    mutex_unlock(&lcd->lock);
+    lcd_kick(lcd);
+    return 0;
+}
+
+/*
+code of the CGRAM slot holding bitmap, queueing its upload if it is not
+resident yet; -EBUSY when all slots are displayed
+*/
+static int lcd_glyph_lookup(struct lcd1602_data *lcd, const u8 *bitmap) {
+    bool upload = false;
+    u8 in_use;
+    int slot;
+
+    mutex_lock(&lcd->lock);
+    in_use = lcd_glyph_in_use(&lcd->shm->ddram[0][0],
+                              sizeof(lcd->shm->ddram));
+    slot = lcd_glyph_get(&lcd->glyphs, bitmap, in_use);
+    if (slot >= 0 && (lcd->glyphs.upload & BIT(slot))) {
+        upload = true;
+        lcd->commit_seq++;
+    }
+    mutex_unlock(&lcd->lock);
+
+    if (slot < 0)
+        return -EBUSY;
+    if (upload)
+        lcd_kick(lcd);
+    return slot;
+}
+
+static enum hrtimer_restart lcd_anim_tick(struct hrtimer *timer) {
+    struct lcd_anim *anim = container_of(timer, struct lcd_anim, timer);
+
+    atomic_inc(&anim->steps);
+    lcd_kick(anim->lcd);
+    hrtimer_forward_now(timer, anim->period);
+    return HRTIMER_RESTART;
+}
+
+/* reserve a slot for the animation, show frame 0 and start the timer */
+static int lcd_anim_start(struct lcd1602_data *lcd, struct lcd1602_file *f,
+                          const struct lcd1602_anim *req) {
+    struct lcd_anim *anim;
+    u8 in_use;
+    int slot;
+
+    if (!req->period_ms || !req->nframes ||
+        req->nframes > LCD1602_ANIM_FRAMES ||
+        req->reserved[0] || req->reserved[1])
+        return -EINVAL;
+
+    mutex_lock(&lcd->lock);
+    in_use = lcd_glyph_in_use(&lcd->shm->ddram[0][0],
+                              sizeof(lcd->shm->ddram));
+    slot = lcd_glyph_reserve(&lcd->glyphs, req->frames[0], in_use);
+    if (slot < 0) {
+        mutex_unlock(&lcd->lock);
+        return -EBUSY;
+    }
+    anim = &lcd->anims[slot];
+    memcpy(anim->frames, req->frames, sizeof(anim->frames));
+    anim->nframes = req->nframes;
+    anim->frame = 0;
+    anim->period = ms_to_ktime(req->period_ms);
+    atomic_set(&anim->steps, 0);
+    anim->active = true;
+    anim->owner = f;
+    lcd->commit_seq++;
+    if (req->nframes > 1 && !lcd->gone)
+        hrtimer_start(&anim->timer, anim->period, HRTIMER_MODE_REL);
+    mutex_unlock(&lcd->lock);
+
+    lcd_kick(lcd);
+    return slot;
+}
+
+/*
+stop an animation f started; the tick never takes lock, so the timer
+is cancelled under it, after the owner check
+*/
+static int lcd_anim_stop(struct lcd1602_data *lcd, struct lcd1602_file *f,
+                         int code) {
+    struct lcd_anim *anim;
+    int ret = 0;
+
+    if (code < 0 || code >= 2 * LCD_CGRAM_SLOTS)
+        return -EINVAL;
+    anim = &lcd->anims[code % LCD_CGRAM_SLOTS];
+
+    mutex_lock(&lcd->lock);
+    if (!anim->active) {
+        ret = -EINVAL;
+    } else if (anim->owner != f) {
+        ret = -EPERM;
+    } else {
+        hrtimer_cancel(&anim->timer);
+        anim->active = false;
+        anim->owner = NULL;
+        atomic_set(&anim->steps, 0);
+        lcd_glyph_release(&lcd->glyphs, code % LCD_CGRAM_SLOTS);
+    }
+    mutex_unlock(&lcd->lock);
+    return ret;
+}
+
+/* render a bar graph into the draw page, see lcd1602_widget.h */
+static int lcd_bar_draw(struct lcd1602_data *lcd, const struct lcd1602_file *f,
+                        const struct lcd1602_bar *bar) {
+    unsigned int base = f->draw_page * LCD_COLS + bar->col;
+    unsigned int i;
+    u8 cells[LCD_COLS];
+    bool changed;
+    int code;
+
+    if (bar->row >= LCD_ROWS || !bar->width || !bar->max ||
+        bar->col + bar->width > LCD_COLS)
+        return -EINVAL;
+
+    mutex_lock(&lcd->lock);
+    code = lcd_bar_render(cells, &lcd->glyphs, &lcd->shm->ddram[0][0],
+                          bar->row, base, bar->width, bar->value, bar->max);
+    if (code < 0) {
+        mutex_unlock(&lcd->lock);
+        return -EBUSY;
+    }
+    changed = code < LCD_CGRAM_SLOTS && (lcd->glyphs.upload & BIT(code));
+    for (i = 0; i < bar->width; i++)
+        changed |= lcd_shadow_put(lcd->shm, bar->row, base + i, cells[i]);
+    if (changed)
+        lcd->commit_seq++;
+    mutex_unlock(&lcd->lock);
+
+    if (changed)
+        lcd_kick(lcd);
+    return 0;
+}
+
+/*
+load and pin the big-digit glyphs the first time they are drawn, they go
+out with the next flush; called under lock, -EBUSY without 3 free slots
+*/
+static int lcd_big_pin(struct lcd1602_data *lcd) {
+    u8 bitmap[LCD_GLYPH_ROWS];
+    unsigned int i;
+    u8 in_use;
+    int slot;
+
+    if (lcd->big_pinned)
+        return 0;
+    in_use = lcd_glyph_in_use(&lcd->shm->ddram[0][0], sizeof(lcd->shm->ddram));
+    for (i = 0; i < LCD_BIG_GLYPHS; i++) {
+        lcd_big_glyph(bitmap, i);
+        slot = lcd_glyph_pin(&lcd->glyphs, bitmap, in_use);
+        if (slot < 0) {
+            while (i--)
+                lcd_glyph_release(&lcd->glyphs, lcd->big_codes[i]);
+            return -EBUSY;
+        }
+        lcd->big_codes[i] = slot;
+    }
+    lcd->big_pinned = true;
+    return 0;
+}
+
+/* big digits into the draw page, see lcd1602_widget.h */
+static int lcd_big_draw(struct lcd1602_data *lcd, const struct lcd1602_file *f,
+                        const struct lcd1602_big *big) {
+    unsigned int base = f->draw_page * LCD_COLS + big->col;
+    u8 cells[LCD_ROWS][LCD_COLS];
+    unsigned int row, i;
+    bool changed = false;
+    int ret;
+
+    if (big->col >= LCD_COLS || big->len > sizeof(big->text))
+        return -EINVAL;
+
+    mutex_lock(&lcd->lock);
+    ret = lcd_big_pin(lcd);
+    if (!ret)
+        ret = lcd_big_render(cells, LCD_COLS - big->col,
+                             (const char *)big->text, big->len, lcd->big_codes);
+    if (ret < 0) {
+        mutex_unlock(&lcd->lock);
+        return ret;
+    }
+    for (row = 0; row < LCD_ROWS; row++)
+        for (i = 0; i < LCD_COLS - big->col; i++)
+            changed |= lcd_shadow_put(lcd->shm, row, base + i, cells[row][i]);
+    if (changed)
+        lcd->commit_seq++;
+    mutex_unlock(&lcd->lock);
+
+    if (changed)
+        lcd_kick(lcd);
+    return 0;
+}
+
+/*
+LCD1602_IOC_FLUSH: doorbell for mmap() users, commit whatever they marked dirty
+LCD1602_IOC_DRAW_PAGE/SHOW_PAGE: page flipping, see lcd1602_ioctl.h
+LCD1602_IOC_MARQUEE: hardware scrolling, see lcd1602_ioctl.h
+LCD1602_IOC_GLYPH: custom characters through the CGRAM cache
+LCD1602_IOC_ANIM/ANIM_STOP: glyphs animated in CGRAM, see lcd1602_ioctl.h
+LCD1602_IOC_BAR: bar graph widget
+LCD1602_IOC_BIG: big digits
+LCD1602_IOC_ACK: acknowledge the glass, clears EPOLLPRI
+*/
+static long lcd1602_ioctl(struct file *filp, unsigned int cmd,
+                          unsigned long arg) {
+    struct lcd1602_file *f = filp->private_data;
+    struct lcd1602_data *lcd = f->lcd;
+    struct lcd1602_marquee mq;
+    struct lcd1602_glyph glyph;
+    struct lcd1602_anim anim;
+    struct lcd1602_bar bar;
+    struct lcd1602_big big;
+    bool changed;
+    int page, code, ret;
+
+    ret = lcd_check_gone(lcd);
+    if (ret)
+        return ret;
+
+    switch (cmd) {
+    case LCD1602_IOC_FLUSH:
+        mutex_lock(&lcd->lock);
+        changed = lcd_shm_dirty(lcd->shm);
+        if (changed)
+            lcd->commit_seq++;
+        mutex_unlock(&lcd->lock);
+        if (changed)
+            lcd_kick(lcd);
+        return 0;
+    case LCD1602_IOC_DRAW_PAGE:
+        if (get_user(page, (int __user *)arg))
+            return -EFAULT;
+        if (page < 0 || page >= LCD_PAGES)
+            return -EINVAL;
+        f->draw_page = page;
+        return 0;
+    case LCD1602_IOC_SHOW_PAGE:
+        if (get_user(page, (int __user *)arg))
+            return -EFAULT;
+        if (page < 0 || page >= LCD_PAGES)
+            return -EINVAL;
+        mutex_lock(&lcd->lock);
+        ret = lcd_marquee_stop(lcd, f);
+        changed = !ret && lcd->want_shift != page * LCD_COLS;
+        if (changed) {
+            lcd->want_shift = page * LCD_COLS;
+            lcd->commit_seq++;
+        }
+        mutex_unlock(&lcd->lock);
+        if (ret)
+            return ret;
+        if (changed)
+            lcd_kick(lcd);
+        return 0;
+    case LCD1602_IOC_MARQUEE:
+        if (copy_from_user(&mq, (void __user *)arg, sizeof(mq)))
+            return -EFAULT;
+        return lcd_marquee_start(lcd, f, &mq);
+    case LCD1602_IOC_GLYPH:
+        if (copy_from_user(&glyph, (void __user *)arg, sizeof(glyph)))
+            return -EFAULT;
+        ret = lcd_glyph_lookup(lcd, glyph.bitmap);
+        if (ret < 0)
+            return ret;
+        glyph.code = ret;
+        if (copy_to_user((void __user *)arg, &glyph, sizeof(glyph)))
+            return -EFAULT;
+        return 0;
+    case LCD1602_IOC_ANIM:
+        if (copy_from_user(&anim, (void __user *)arg, sizeof(anim)))
+            return -EFAULT;
+        ret = lcd_anim_start(lcd, f, &anim);
+        if (ret < 0)
+            return ret;
+        anim.code = ret;
+        if (copy_to_user((void __user *)arg, &anim, sizeof(anim))) {
+            lcd_anim_stop(lcd, f, anim.code);
+            return -EFAULT;
+        }
+        return 0;
+    case LCD1602_IOC_ANIM_STOP:
+        if (get_user(code, (int __user *)arg))
+            return -EFAULT;
+        return lcd_anim_stop(lcd, f, code);
+    case LCD1602_IOC_BAR:
+        if (copy_from_user(&bar, (void __user *)arg, sizeof(bar)))
+            return -EFAULT;
+        return lcd_bar_draw(lcd, f, &bar);
+    case LCD1602_IOC_BIG:
+        if (copy_from_user(&big, (void __user *)arg, sizeof(big)))
+            return -EFAULT;
+        return lcd_big_draw(lcd, f, &big);
+    case LCD1602_IOC_ACK:
+        lcd_ack(f);
+        return 0;
+    default:
+        return -ENOTTY;
+    }
+}
+
+/*
+map the shadow page; vm_insert_page() takes its own page reference,
+so a mapping may outlive the device without pointing at freed memory
+*/
+static int lcd1602_mmap(struct file *filp, struct vm_area_struct *vma) {
+    struct lcd1602_file *f = filp->private_data;
+    int ret;
+
+    ret = lcd_check_gone(f->lcd);
+    if (ret)
+        return ret;
+    if (vma->vm_pgoff || vma->vm_end - vma->vm_start != PAGE_SIZE)
+        return -EINVAL;
+    if (!(vma->vm_flags & VM_SHARED))
+        return -EINVAL;
+    vma->vm_flags |= VM_DONTEXPAND | VM_DONTDUMP;
+    return vm_insert_page(vma, vma->vm_start, virt_to_page(f->lcd->shm));
+}
+
+static int lcd1602_open(struct inode *inode, struct file *filp) {
+    struct lcd1602_data *lcd = container_of(filp->private_data,
+                                            struct lcd1602_data, miscdev);
+    struct lcd1602_file *f;
+
+    f = kzalloc(sizeof(*f), GFP_KERNEL);
+    if (!f)
+        return -ENOMEM;
+    f->lcd = lcd;
+    /* misc_deregister() cannot finish while we run, so probe's ref is held */
+    kref_get(&lcd->ref);
+    mutex_lock(&lcd->lock);
+    f->seen_seq = lcd->glass_seq;
+    mutex_unlock(&lcd->lock);
+    filp->private_data = f;
+    return 0;
+}
+
+static int lcd1602_release(struct inode *inode, struct file *filp) {
+    struct lcd1602_file *f = filp->private_data;
+    unsigned int slot;
+
+    /* the animations die with the file, their slots go back to the cache */
+    for (slot = 0; slot < LCD_CGRAM_SLOTS; slot++)
+        lcd_anim_stop(f->lcd, f, slot);
+    /* and so does its marquee, stopped where it is */
+    mutex_lock(&f->lcd->lock);
+    lcd_marquee_stop(f->lcd, f);
+    mutex_unlock(&f->lcd->lock);
+    kref_put(&f->lcd->ref, lcd_free);
+    kfree(f);
+    return 0;
+}
+
+static const struct file_operations lcd1602_fops = {
+    .owner = THIS_MODULE,
+    .open = lcd1602_open,
+    .release = lcd1602_release,
+    .write = lcd1602_write,
+    .fsync = lcd1602_fsync,
+    .poll = lcd1602_poll,
+    .unlocked_ioctl = lcd1602_ioctl,
+    .compat_ioctl = compat_ptr_ioctl,
+    .mmap = lcd1602_mmap,
+    .llseek = no_llseek,
+};
+
+
+/*
+bus clock for the timing plan: a "clock-frequency" hint on the lcd node
+wins, then the one on the adapter's controller node, then standard mode.
+A hint above LCD_BUS_HZ_MAX is a typo, not a bus, and is ignored.
+*/
+static u32 lcd_bus_hz(struct i2c_client *client) {
+    struct device *parent = client->adapter->dev.parent;
+    u32 hz;
+
+    if (device_property_read_u32(&client->dev, "clock-frequency", &hz) ||
+        !hz) {
+        if (!parent ||
+            device_property_read_u32(parent, "clock-frequency", &hz))
+            hz = 0;
+    }
+    if (!hz)
+        return LCD_BUS_HZ_DEFAULT;
+    if (hz > LCD_BUS_HZ_MAX) {
+        dev_warn(&client->dev,
+                 "clock-frequency %u out of range, assuming %u\n",
+                 hz, LCD_BUS_HZ_DEFAULT);
+        return LCD_BUS_HZ_DEFAULT;
+    }
+    return hz;
+}
+
+static int lcd1602_timing_show(struct seq_file *m, void *v) {
+    struct lcd1602_data *lcd = m->private;
+    const struct lcd_timing *t = &lcd->timing;
+
+    seq_printf(m, "bus_hz: %u\n", t->bus_hz);
+    seq_printf(m, "byte_ns: %u\n", t->byte_ns);
+    seq_printf(m, "pad_bytes: %u\n", t->pad_bytes);
+    /* data writes never sleep, the bytes between EN edges are the delay */
+    seq_printf(m, "exec_gap_ns: %u\n", (2 + t->pad_bytes) * t->byte_ns);
+    seq_printf(m, "slow_cmd_us: %u%s\n", t->slow_cmd_us,
+               lcd->busy_poll ? " (busy_poll)" : "");
+    seq_printf(m, "init_long_us: %u\n", t->init_long_us);
+    seq_printf(m, "init_short_us: %u\n", t->init_short_us);
+    seq_printf(m, "clear_cost: %u\n", lcd->exec.cost.clear_cost);
+    return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(lcd1602_timing);
+
+/*
+wiring of the backpack: a "pin-map" property on the lcd node wins,
+then the pinmap module parameter, then the layout documented above
+*/
+static int lcd_pinmap(struct i2c_client *client, struct lcd_pinmap *map) {
+    static const struct lcd_pinmap def = LCD_PINMAP_DEFAULT;
+    u32 pins[LCD_PINMAP_LEN];
+    unsigned int i;
+    int ret;
+
+    if (!device_property_read_u32_array(&client->dev, "pin-map", pins,
+                                        LCD_PINMAP_LEN)) {
+        ret = lcd_pinmap_set(map, pins);
+    } else if (pinmap_len) {
+        if (pinmap_len != LCD_PINMAP_LEN)
+            return -EINVAL;
+        for (i = 0; i < LCD_PINMAP_LEN; i++)
+            pins[i] = pinmap[i];
+        ret = lcd_pinmap_set(map, pins);
+    } else {
+        *map = def;
+        ret = 0;
+    }
+    return ret;
+}
+
+/*
+probe func - mandatory for i2c drivers
+func is called when the driver is matched with a device.
+check if dev is i2c capable
+initialize the dev
+*/
+static int lcd1602_probe(struct i2c_client *client,
+                         const struct i2c_device_id *id) {
+    struct lcd_pinmap map;
+    struct lcd1602_data *lcd;
+    unsigned int slot;
+    int ret;
+
+    /*
+    check if dev is i2c capable
+    */
+
+    dev_dbg(&client->dev, "probing\n");
+    if (!i2c_check_functionality(client->adapter, I2C_FUNC_I2C)) {
+        dev_err(&client->dev, "I2C functionality not supported\n");
+        return -EIO;
+    }
+    /*
+    not devm: open files keep lcd and the shm page until their release(),
+    which can come after remove(), see lcd_free()
+    */
+    lcd = kzalloc(sizeof(*lcd), GFP_KERNEL);
+    if (!lcd)
+        return -ENOMEM;
+    kref_init(&lcd->ref);
+    BUILD_BUG_ON(sizeof(struct lcd1602_shm) > PAGE_SIZE);
+    BUILD_BUG_ON(LCD1602_ROWS != LCD_ROWS || LCD1602_COLS != LCD_COLS ||
+                 LCD1602_DDRAM_COLS != LCD_DDRAM_COLS);
+    lcd->shm = (struct lcd1602_shm *)get_zeroed_page(GFP_KERNEL);
+    if (!lcd->shm) {
+        ret = -ENOMEM;
+        goto err_free;
+    }
+    lcd->client = client;
+    lcd->backlight = LCD_BL;  // Backlight ON
+    ret = lcd_pinmap(client, &map);
+    if (ret) {
+        dev_err(&client->dev, "Invalid pin map\n");
+        goto err_free;
+    }
+    lcd_encoder_init(&lcd->enc, &map, lcd->backlight);
+    lcd_timing_init(&lcd->timing, lcd_bus_hz(client));
+    lcd_exec_init(&lcd->exec, &lcd_exec_ops, lcd, &lcd->enc, &lcd->timing);
+    lcd_marquee_init(lcd);
+    lcd->busy_poll = busy_poll;
+    lcd_glyph_cache_init(&lcd->glyphs);
+    mutex_init(&lcd->lock);
+    spin_lock_init(&lcd->kick_lock);
+    mutex_init(&lcd->bus_lock);
+    INIT_WORK(&lcd->init_work, lcd_init_work);
+    init_waitqueue_head(&lcd->flush_wq);
+    hrtimer_init(&lcd->marquee_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+    lcd->marquee_timer.function = lcd_marquee_tick;
+    hrtimer_init(&lcd->retry_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+    lcd->retry_timer.function = lcd_retry_tick;
+    lcd->retry_ms = LCD_RETRY_MIN_MS;
+    for (slot = 0; slot < LCD_CGRAM_SLOTS; slot++) {
+        lcd->anims[slot].lcd = lcd;
+        hrtimer_init(&lcd->anims[slot].timer, CLOCK_MONOTONIC,
+                     HRTIMER_MODE_REL);
+        lcd->anims[slot].timer.function = lcd_anim_tick;
+    }
+    memset(lcd->shm->ddram, ' ', sizeof(lcd->shm->ddram));
+    snprintf(lcd->name, sizeof(lcd->name), "lcd1602-%d-%02x",
+             i2c_adapter_id(client->adapter), client->addr);
+    lcd->bus = lcd_bus_get(client->adapter);
+    if (!lcd->bus) {
+        ret = -ENOMEM;
+        goto err_free;
+    }
+    lcd_bus_join(lcd);
+    i2c_set_clientdata(client, lcd);
+
+    lcd->miscdev.minor = MISC_DYNAMIC_MINOR;
+    lcd->miscdev.name = lcd->name;
+    lcd->miscdev.fops = &lcd1602_fops;
+    lcd->miscdev.parent = &client->dev;
+
+    ret = misc_register(&lcd->miscdev);
+    if (ret) {
+        dev_err(&client->dev, "Failed to register misc device: %d\n", ret);
+        lcd_bus_leave(lcd);
+        lcd_bus_put(lcd->bus);
+        goto err_free;
+    }
+    /*
+    the device is usable right away, the display follows; init sleeps
+    for tens of ms, so it goes on the queue meant for long work items
+    */
+    queue_work(system_long_wq, &lcd->init_work);
+
+    lcd->debugfs = debugfs_create_dir(dev_name(&client->dev), lcd1602_debugfs);
+    debugfs_create_file("timing", 0444, lcd->debugfs, lcd,
+                        &lcd1602_timing_fops);
+    return 0;
+
+err_free:
+    kref_put(&lcd->ref, lcd_free);
+    return ret;
+}
+
+static int lcd1602_remove(struct i2c_client *client) {
+    struct lcd1602_data *lcd = i2c_get_clientdata(client);
+    unsigned int slot;
+
+    if (!lcd)
+        return 0;
+    debugfs_remove_recursive(lcd->debugfs);
+    misc_deregister(&lcd->miscdev);
+
+    /*
+    files still open fail from here on: fops see gone under lock, kicks
+    and timer starts stop, and fsync() waiters return -ENODEV
+    */
+    mutex_lock(&lcd->lock);
+    spin_lock_irq(&lcd->kick_lock);
+    lcd->gone = true;
+    spin_unlock_irq(&lcd->kick_lock);
+    mutex_unlock(&lcd->lock);
+    wake_up_interruptible_all(&lcd->flush_wq);
+
+    hrtimer_cancel(&lcd->marquee_timer);
+    for (slot = 0; slot < LCD_CGRAM_SLOTS; slot++)
+        hrtimer_cancel(&lcd->anims[slot].timer);
+    hrtimer_cancel(&lcd->retry_timer);
+    cancel_work_sync(&lcd->init_work);
+    lcd_bus_leave(lcd);
+    lcd_bus_put(lcd->bus);
+    mutex_lock(&lcd->bus_lock);
+    if (lcd->ready)
+        lcd_exec_command(&lcd->exec, LCD_CLEAR);
+    mutex_unlock(&lcd->bus_lock);
+    dev_info(&client->dev, "LCD1602 driver removed\n");
+    kref_put(&lcd->ref, lcd_free);
+    return 0;
+}
+
+static const struct i2c_device_id lcd1602_id[] = {
+    { "lcd1602", 0 },
+    { }
+};
+MODULE_DEVICE_TABLE(i2c, lcd1602_id);
+
+static const struct of_device_id lcd1602_of_match[] = {
+    { .compatible = "hit,hd44780-pcf8574" },
+    { }
+};
+MODULE_DEVICE_TABLE(of, lcd1602_of_match);
+
+static struct i2c_driver lcd1602_driver = {
+    .driver = {
+        .name = "lcd1602",
+        .of_match_table = lcd1602_of_match,
+        .probe_type = PROBE_PREFER_ASYNCHRONOUS,
+    },
+    .probe = lcd1602_probe,
+    .remove = lcd1602_remove,
+    .id_table = lcd1602_id,
+};
+
+static int __init lcd1602_init(void) {
+    int ret;
+
+    lcd1602_debugfs = debugfs_create_dir("lcd1602", NULL);
+    ret = i2c_add_driver(&lcd1602_driver);
+    if (ret)
+        debugfs_remove_recursive(lcd1602_debugfs);
+    return ret;
+}
+
+static void __exit lcd1602_exit(void) {
+    i2c_del_driver(&lcd1602_driver);
+    debugfs_remove_recursive(lcd1602_debugfs);
+}
+
+module_init(lcd1602_init);
+module_exit(lcd1602_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_AUTHOR("PilotChalkanov");
+MODULE_DESCRIPTION("I2C 1602 LCD Driver");
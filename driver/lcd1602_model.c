@@ -0,0 +1,205 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * PCF8574/HD44780 model, see lcd1602_model.h
+ */
+
+#include "driver/lcd1602_model.h"
+
+void lcd_model_init(struct lcd_model *m, const struct lcd_pinmap *map) {
+    memset(m, 0, sizeof(*m));
+    m->map = *map;
+    m->port = 0xFF;
+    /* DDRAM is undefined after power-on, spaces make screens readable */
+    memset(m->ddram, ' ', sizeof(m->ddram));
+    m->increment = 1;
+}
+
+static int lcd_model_pin(const struct lcd_model *m, u8 pin) {
+    return !!(m->port & (1U << pin));
+}
+
+/* the address counter runs through the DDRAM lines or round CGRAM */
+static void lcd_model_step(struct lcd_model *m, int up) {
+    if (m->cgram_selected) {
+        m->ac = (m->ac + (up ? 1 : -1)) & (LCD_MODEL_CGRAM - 1);
+        return;
+    }
+    if (!m->two_line) {
+        m->ac = (m->ac + (up ? 1 : 2 * LCD_MODEL_LINE - 1)) %
+                (2 * LCD_MODEL_LINE);
+        return;
+    }
+    if (up)
+        m->ac = m->ac == 0x27 ? 0x40 : m->ac == 0x67 ? 0x00 : m->ac + 1;
+    else
+        m->ac = m->ac == 0x40 ? 0x27 : m->ac == 0x00 ? 0x67 : m->ac - 1;
+}
+
+static void lcd_model_shift(struct lcd_model *m, int left) {
+    unsigned int len = m->two_line ? LCD_MODEL_LINE : 2 * LCD_MODEL_LINE;
+
+    m->shift = (m->shift + (left ? 1 : len - 1)) % len;
+}
+
+static void lcd_model_instruction(struct lcd_model *m, u8 cmd) {
+    if (cmd & LCD_SET_DDRAM) {
+        m->ac = cmd & 0x7F;
+        m->cgram_selected = 0;
+    } else if (cmd & LCD_SET_CGRAM) {
+        m->ac = cmd & 0x3F;
+        m->cgram_selected = 1;
+    } else if (cmd & LCD_FUNCTION_SET) {
+        u8 four_bit = !(cmd & 0x10);
+
+        if (m->four_bit != four_bit) {
+            m->four_bit = four_bit;
+            m->second_nibble = 0;
+            m->read_second = 0;
+        }
+        m->two_line = !!(cmd & LCD_2LINE);
+    } else if (cmd & LCD_CURSOR_SHIFT) {
+        if (cmd & LCD_DISPLAY_MOVE)
+            lcd_model_shift(m, !(cmd & LCD_MOVE_RIGHT));
+        else
+            lcd_model_step(m, cmd & LCD_MOVE_RIGHT);
+    } else if (cmd & LCD_DISPLAY_CONTROL) {
+        m->display_on = !!(cmd & LCD_DISPLAY_ON);
+    } else if (cmd & LCD_ENTRY_MODE) {
+        m->increment = !!(cmd & LCD_ENTRY_LEFT);
+        m->entry_shift = cmd & 0x01;
+    } else if (cmd & LCD_HOME) {
+        m->ac = 0;
+        m->cgram_selected = 0;
+        m->shift = 0;
+    } else if (cmd & LCD_CLEAR) {
+        memset(m->ddram, ' ', sizeof(m->ddram));
+        m->ac = 0;
+        m->cgram_selected = 0;
+        m->shift = 0;
+        m->increment = 1;
+    }
+}
+
+static void lcd_model_execute(struct lcd_model *m, int rs, u8 value) {
+    if (!rs) {
+        m->instructions++;
+        lcd_model_instruction(m, value);
+        return;
+    }
+    m->data_writes++;
+    if (m->cgram_selected) {
+        m->cgram[m->ac & (LCD_MODEL_CGRAM - 1)] = value;
+    } else {
+        m->ddram[m->ac] = value;
+        if (m->entry_shift)
+            lcd_model_shift(m, m->increment);
+    }
+    lcd_model_step(m, m->increment);
+}
+
+static u8 lcd_model_nibble(const struct lcd_model *m) {
+    u8 nibble = 0;
+    unsigned int i;
+
+    for (i = 0; i < 4; i++)
+        if (lcd_model_pin(m, m->map.data[i]))
+            nibble |= 1U << i;
+    return nibble;
+}
+
+int lcd_model_latch(struct lcd_model *m, int rs, u8 nibble) {
+    u8 value;
+
+    nibble &= 0x0F;
+    if (!m->four_bit) {
+        /* only D7-D4 are wired, D3-D0 read as 0 */
+        value = nibble << 4;
+    } else if (!m->second_nibble) {
+        m->high_nibble = nibble;
+        m->second_nibble = 1;
+        return -1;
+    } else {
+        m->second_nibble = 0;
+        value = m->high_nibble << 4 | nibble;
+    }
+    lcd_model_execute(m, rs, value);
+    return value;
+}
+
+/* a data read moves the address counter once both nibbles are out */
+void lcd_model_read_done(struct lcd_model *m, int rs) {
+    if (m->four_bit && !m->read_second) {
+        m->read_second = 1;
+        return;
+    }
+    m->read_second = 0;
+    if (rs)
+        lcd_model_step(m, m->increment);
+}
+
+static void lcd_model_port(struct lcd_model *m, u8 port) {
+    int was_en = lcd_model_pin(m, m->map.en);
+    int rs;
+
+    m->port = port;
+    m->port_writes++;
+    if (!was_en || lcd_model_pin(m, m->map.en))
+        return;
+    m->en_edges++;
+    rs = lcd_model_pin(m, m->map.rs);
+    if (lcd_model_pin(m, m->map.rw))
+        lcd_model_read_done(m, rs);
+    else
+        lcd_model_latch(m, rs, lcd_model_nibble(m));
+}
+
+void lcd_model_write(struct lcd_model *m, const u8 *buf, unsigned int len) {
+    unsigned int i;
+
+    m->messages++;
+    for (i = 0; i < len; i++)
+        lcd_model_port(m, buf[i]);
+}
+
+u8 lcd_model_drive(const struct lcd_model *m, int rs) {
+    u8 value;
+
+    if (!rs)
+        value = m->ac & 0x7F;       /* BF is never set */
+    else if (m->cgram_selected)
+        value = m->cgram[m->ac & (LCD_MODEL_CGRAM - 1)];
+    else
+        value = m->ddram[m->ac];
+    if (m->four_bit && m->read_second)
+        return value & 0x0F;
+    return value >> 4;
+}
+
+void lcd_model_read(struct lcd_model *m, u8 *buf, unsigned int len) {
+    unsigned int i, bit;
+    u8 value, nibble;
+
+    m->messages++;
+    for (i = 0; i < len; i++) {
+        value = m->port;
+        m->port_reads++;
+        if (lcd_model_pin(m, m->map.rw) && lcd_model_pin(m, m->map.en)) {
+            /* quasi-bidirectional: a pin written high reads the LCD */
+            nibble = lcd_model_drive(m, lcd_model_pin(m, m->map.rs));
+            for (bit = 0; bit < 4; bit++)
+                if (!(nibble & (1U << bit)))
+                    value &= ~(1U << m->map.data[bit]);
+        }
+        buf[i] = value;
+    }
+}
+
+u8 lcd_model_cell(const struct lcd_model *m, unsigned int row,
+                  unsigned int col) {
+    if (m->two_line)
+        return m->ddram[LCD_ROW_ADDR(row) + (col + m->shift) % LCD_MODEL_LINE];
+    /* 1-line mode: one 80-character line, the second row stays dark */
+    if (row)
+        return ' ';
+    return m->ddram[(col + m->shift) % (2 * LCD_MODEL_LINE)];
+}
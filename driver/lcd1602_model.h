@@ -0,0 +1,81 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * PCF8574/HD44780 model, for the virtual I2C adapter and the simulator
+ *
+ * It takes the port bytes of I2C write messages, latches them onto P0-P7
+ * and clocks every EN falling edge into an HD44780 in 8-bit or 4-bit mode.
+ * DDRAM, CGRAM, the address counter, entry mode and display shift are
+ * tracked; read messages return what the controller drives onto D7-D4,
+ * BF is always 0. There is no timing: the host simulator
+ * (sim/hd44780_sim.h) drives the controller half of this model through
+ * lcd_model_latch() and friends and adds the timing checks on top, so
+ * both run the same controller.
+ */
+#ifndef DRIVER_LCD1602_MODEL_H_
+#define DRIVER_LCD1602_MODEL_H_
+
+#include "driver/lcd1602.h"
+#include "driver/lcd1602_encode.h"
+
+#define LCD_MODEL_DDRAM   0x80
+#define LCD_MODEL_CGRAM   0x40
+#define LCD_MODEL_LINE    40    /* DDRAM per row in 2-line mode */
+
+struct lcd_model {
+    struct lcd_pinmap map;
+    u8 port;                /* last byte written, all high at power-on */
+
+    u8 ddram[LCD_MODEL_DDRAM];
+    u8 cgram[LCD_MODEL_CGRAM];
+    u8 ac;
+    u8 cgram_selected;
+    u8 four_bit;
+    u8 two_line;
+    u8 display_on;
+    u8 increment;
+    u8 entry_shift;
+    u8 shift;               /* left shifts, mod the line length */
+    u8 second_nibble;       /* 4-bit mode: the high nibble is latched */
+    u8 high_nibble;
+    u8 read_second;         /* 4-bit mode: the high nibble was read */
+
+    /* what the driver sent, for the debugfs stats */
+    u64 messages;
+    u64 port_writes;
+    u64 port_reads;
+    u64 en_edges;
+    u64 instructions;
+    u64 data_writes;
+};
+
+/* power-on state: 8-bit, 1-line, display off, DDRAM spaces */
+void lcd_model_init(struct lcd_model *m, const struct lcd_pinmap *map);
+
+/* one I2C write message, every byte latched onto the port in turn */
+void lcd_model_write(struct lcd_model *m, const u8 *buf, unsigned int len);
+
+/* one I2C read message, the port sampled for every byte */
+void lcd_model_read(struct lcd_model *m, u8 *buf, unsigned int len);
+
+/*
+ * The controller alone, without the port. An EN falling edge with RW low
+ * latches nibble off D7-D4: returns the byte that completed, or -1 when
+ * only the high nibble of a 4-bit transfer was latched.
+ */
+int lcd_model_latch(struct lcd_model *m, int rs, u8 nibble);
+
+/* what the controller drives onto D7-D4 while EN is high with RW high */
+u8 lcd_model_drive(const struct lcd_model *m, int rs);
+
+/* EN falling edge with RW high, ends the nibble lcd_model_drive() gave */
+void lcd_model_read_done(struct lcd_model *m, int rs);
+
+/* character code shown at a visible cell */
+u8 lcd_model_cell(const struct lcd_model *m, unsigned int row,
+                  unsigned int col);
+
+static inline int lcd_model_backlight(const struct lcd_model *m) {
+    return !!(m->port & (1U << m->map.bl));
+}
+
+#endif  // DRIVER_LCD1602_MODEL_H_
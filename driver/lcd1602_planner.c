@@ -0,0 +1,184 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * Flush planner, see lcd1602_planner.h
+ */
+
+#include "driver/lcd1602_planner.h"
+
+void lcd_cost_model_init(struct lcd_cost_model *cm, unsigned int byte_cost,
+                         unsigned int byte_ns) {
+    cm->byte_cost = byte_cost;
+    cm->clear_cost = byte_cost +
+        (LCD_SLOW_EXEC_NS + byte_ns - 1) / byte_ns;
+}
+
+int lcd_ac_next(unsigned int row, unsigned int col) {
+    /* in 2-line mode the counter wraps from 0x27 to 0x40 and 0x67 to 0x00 */
+    if (col + 1 < LCD_DDRAM_COLS)
+        return LCD_ROW_ADDR(row) + col + 1;
+    return LCD_ROW_ADDR((row + 1) % LCD_ROWS);
+}
+
+/* column of the address counter if it points into row, else -1 */
+static int lcd_ac_col(int ac, unsigned int row) {
+    int col = ac - LCD_ROW_ADDR(row);
+
+    if (ac == LCD_AC_UNKNOWN || col < 0 || col >= LCD_DDRAM_COLS)
+        return -1;
+    return col;
+}
+
+static void lcd_plan_push(struct lcd_plan *plan, u8 type, unsigned int row,
+                          unsigned int col, unsigned int len) {
+    struct lcd_op *op;
+
+    if (!plan)
+        return;
+    op = &plan->ops[plan->nops++];
+    op->type = type;
+    op->row = row;
+    op->col = col;
+    op->len = len;
+}
+
+/*
+Cover every bit of need[] with DATA ops, rows taken in order starting at
+first_row, and return the cost. Each run leaves the cursor right after its
+last cell, so every gap can be decided on its own: write through the
+unchanged cells when that is no dearer than one Set-DDRAM command.
+With plan == NULL only the cost is computed.
+*/
+static unsigned int lcd_plan_rows(struct lcd_plan *plan, const u64 *need,
+                                  unsigned int first_row, int *ac,
+                                  const struct lcd_cost_model *cm) {
+    unsigned int cost = 0;
+    unsigned int i, row, col, end;
+    int pos, run;
+
+    for (i = 0; i < LCD_ROWS; i++) {
+        row = (first_row + i) % LCD_ROWS;
+        pos = lcd_ac_col(*ac, row);
+        run = pos;  /* start of the run being written, -1 if none */
+        for (col = 0; col < LCD_DDRAM_COLS; col = end) {
+            if (!(need[row] & BIT_ULL(col))) {
+                end = col + 1;
+                continue;
+            }
+            for (end = col; end < LCD_DDRAM_COLS &&
+                 (need[row] & BIT_ULL(end)); end++)
+                ;
+            if (pos >= 0 && pos <= (int)col &&
+                (col - pos) * cm->byte_cost <= cm->byte_cost) {
+                cost += (end - pos) * cm->byte_cost;
+            } else {
+                if (run >= 0 && pos > run)
+                    lcd_plan_push(plan, LCD_OP_DATA, row, run, pos - run);
+                lcd_plan_push(plan, LCD_OP_ADDR, row, col, 0);
+                cost += (1 + end - col) * cm->byte_cost;
+                run = col;
+            }
+            *ac = lcd_ac_next(row, end - 1);
+            pos = lcd_ac_col(*ac, row);
+            if (pos < 0) {
+                /* wrapped off the end of the row */
+                lcd_plan_push(plan, LCD_OP_DATA, row, run, end - run);
+                run = -1;
+            }
+        }
+        if (run >= 0 && pos > run)
+            lcd_plan_push(plan, LCD_OP_DATA, row, run, pos - run);
+    }
+    return cost;
+}
+
+/* the row order only matters when the cursor already sits in a later row */
+static unsigned int lcd_plan_best_order(const u64 *need, int ac,
+                                        const struct lcd_cost_model *cm,
+                                        unsigned int *first_row) {
+    unsigned int first, cost, best = 0;
+    int a;
+
+    for (first = 0; first < LCD_ROWS; first++) {
+        a = ac;
+        cost = lcd_plan_rows(NULL, need, first, &a, cm);
+        if (first == 0 || cost < best) {
+            best = cost;
+            *first_row = first;
+        }
+    }
+    return best;
+}
+
+void lcd_plan_frame(struct lcd_plan *plan, const struct lcd_shadow *sh,
+                    int ac, const struct lcd_cost_model *cm) {
+    u64 blank_need[LCD_ROWS];
+    unsigned int row, col, inc_first, clr_first;
+    unsigned int inc_cost, clr_cost;
+
+    plan->nops = 0;
+    plan->cost = 0;
+    plan->ac = ac;
+    plan->shift = LCD_SHIFT_UNKNOWN;
+
+    /* after a clear only the non-space cells need writing */
+    for (row = 0; row < LCD_ROWS; row++) {
+        blank_need[row] = 0;
+        for (col = 0; col < LCD_DDRAM_COLS; col++)
+            if (sh->ddram[row][col] != ' ')
+                blank_need[row] |= BIT_ULL(col);
+    }
+
+    inc_cost = lcd_plan_best_order(sh->dirty, ac, cm, &inc_first);
+    clr_cost = cm->clear_cost + lcd_plan_best_order(blank_need, 0, cm,
+                                                    &clr_first);
+    if (clr_cost < inc_cost) {
+        lcd_plan_push(plan, LCD_OP_CLEAR, 0, 0, 0);
+        plan->ac = 0;
+        plan->cost = cm->clear_cost +
+            lcd_plan_rows(plan, blank_need, clr_first, &plan->ac, cm);
+    } else {
+        plan->cost = lcd_plan_rows(plan, sh->dirty, inc_first, &plan->ac, cm);
+    }
+}
+
+/* fewest shift commands from one window start to another, and their way */
+static unsigned int lcd_shift_steps(int from, int to, u8 *dir) {
+    /* shifting left moves the window to higher columns */
+    unsigned int left = (to - from + LCD_DDRAM_COLS) % LCD_DDRAM_COLS;
+
+    if (left <= LCD_DDRAM_COLS - left) {
+        *dir = LCD_MOVE_LEFT;
+        return left;
+    }
+    *dir = LCD_MOVE_RIGHT;
+    return LCD_DDRAM_COLS - left;
+}
+
+void lcd_plan_shift(struct lcd_plan *plan, int shift, int want,
+                    const struct lcd_cost_model *cm) {
+    unsigned int steps = 0, home_steps, direct = ~0U, home;
+    u8 dir = LCD_MOVE_LEFT, home_dir;
+
+    if (plan->nops && plan->ops[0].type == LCD_OP_CLEAR)
+        shift = 0;
+    plan->shift = want;
+
+    home_steps = lcd_shift_steps(0, want, &home_dir);
+    home = cm->clear_cost + home_steps * cm->byte_cost;
+    if (shift != LCD_SHIFT_UNKNOWN) {
+        steps = lcd_shift_steps(shift, want, &dir);
+        direct = steps * cm->byte_cost;
+    }
+
+    if (direct <= home) {
+        if (steps)
+            lcd_plan_push(plan, LCD_OP_SHIFT, 0, dir, steps);
+        plan->cost += direct;
+    } else {
+        lcd_plan_push(plan, LCD_OP_HOME, 0, 0, 0);
+        if (home_steps)
+            lcd_plan_push(plan, LCD_OP_SHIFT, 0, home_dir, home_steps);
+        plan->ac = 0;
+        plan->cost += home;
+    }
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * Flush planner: cheapest HD44780 command sequence for a shadow frame
+ *
+ * Costs are counted in PCF8574 port bytes, the unit that actually occupies
+ * the bus. A Set-DDRAM command costs the same as a character, so a gap of
+ * one unchanged cell between two dirty runs is written through rather than
+ * re-addressed, and a run that starts where the address counter already
+ * points needs no command at all.
+ *
+ * Clear and home execute in 1.52ms, which the model charges as the number
+ * of port bytes the bus could have carried meanwhile. Clear is only chosen
+ * when blanking the DDRAM and rewriting the non-space cells beats the
+ * incremental update. Home is never used for addressing: it does nothing
+ * a 0x80 Set-DDRAM command does not do at the cost of a single byte. It is
+ * only considered to undo a display shift, against the shift commands it
+ * replaces.
+ *
+ * The display shift picks which 16 of the 40 DDRAM columns are visible.
+ * Each shift command moves the window by one column either way round the
+ * 40-column ring and leaves the address counter alone.
+ */
+#ifndef DRIVER_LCD1602_PLANNER_H_
+#define DRIVER_LCD1602_PLANNER_H_
+
+#include "driver/lcd1602.h"
+#include "driver/lcd1602_encode.h"
+
+/* address counter not known, e.g. after an I2C error */
+#define LCD_AC_UNKNOWN  (-1)
+
+/* display shift not known, only a home can resynchronise it */
+#define LCD_SHIFT_UNKNOWN  (-1)
+
+enum lcd_op_type {
+    LCD_OP_ADDR,    /* Set-DDRAM to row/col */
+    LCD_OP_DATA,    /* len characters from the shadow starting at row/col */
+    LCD_OP_CLEAR,   /* clear display, AC and shift back to 0 */
+    LCD_OP_SHIFT,   /* len display shifts, col = LCD_MOVE_LEFT/RIGHT */
+    LCD_OP_HOME,    /* AC and shift back to 0 */
+};
+
+struct lcd_op {
+    u8 type;
+    u8 row;
+    u8 col;
+    u8 len;
+};
+
+struct lcd_cost_model {
+    unsigned int byte_cost;    /* port bytes per character or short command */
+    unsigned int clear_cost;   /* port bytes of a clear incl. its wait */
+};
+
+/*
+worst case: every other cell dirty, one ADDR + one DATA each, plus clear,
+then a home and a shift
+*/
+#define LCD_PLAN_MAX_OPS  (LCD_ROWS * LCD_DDRAM_COLS + 3)
+
+struct lcd_plan {
+    struct lcd_op ops[LCD_PLAN_MAX_OPS];
+    unsigned int nops;
+    unsigned int cost;  /* port bytes, including waits */
+    int ac;             /* DDRAM address after the plan ran */
+    int shift;          /* first visible column after lcd_plan_shift() */
+};
+
+/* byte_cost from lcd_stream_byte_cost(), byte_ns from lcd_timing */
+void lcd_cost_model_init(struct lcd_cost_model *cm, unsigned int byte_cost,
+                         unsigned int byte_ns);
+
+/*
+ * Plan the update of every dirty cell of sh, starting from DDRAM address
+ * ac (or LCD_AC_UNKNOWN). The plan leaves sh untouched.
+ */
+void lcd_plan_frame(struct lcd_plan *plan, const struct lcd_shadow *sh,
+                    int ac, const struct lcd_cost_model *cm);
+
+/*
+Append the cheapest way to move the visible window from column shift
+(or LCD_SHIFT_UNKNOWN) to column want. Call after lcd_plan_frame(),
+a clear in the frame plan already brought the shift back to 0.
+*/
+void lcd_plan_shift(struct lcd_plan *plan, int shift, int want,
+                    const struct lcd_cost_model *cm);
+
+/* DDRAM address the controller moves to after writing at row/col */
+int lcd_ac_next(unsigned int row, unsigned int col);
+
+#endif  // DRIVER_LCD1602_PLANNER_H_
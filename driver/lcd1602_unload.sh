@@ -3,11 +3,11 @@
 # Script to unload the I2C LCD1602 driver module
 
 MODULE_NAME="lcd1602"
-DEVICE_NAME="lcd1602"
+DEVICE_GLOB="/dev/lcd1602-*"
 
 echo "Unloading ${MODULE_NAME} module..."
 
-if lsmod | grep -q "${MODULE_NAME}"; then
+if lsmod | grep -q "^${MODULE_NAME} "; then
     sudo rmmod "${MODULE_NAME}"
     echo "${MODULE_NAME} module unloaded successfully!"
 else
@@ -15,14 +15,14 @@ else
     exit 1
 fi
 
-# Remove the device file
-if [ -e "/dev/${DEVICE_NAME}" ]; then
-    echo "Removing /dev/${DEVICE_NAME}..."
-    sudo rm -f "/dev/${DEVICE_NAME}"
+# Remove device files left behind without devtmpfs
+if compgen -G "${DEVICE_GLOB}" > /dev/null; then
+    echo "Removing ${DEVICE_GLOB}..."
+    sudo rm -f ${DEVICE_GLOB}
 fi
 
 # Verify the module is unloaded
-if ! lsmod | grep -q "${MODULE_NAME}"; then
+if ! lsmod | grep -q "^${MODULE_NAME} "; then
     echo "Module removal verified"
     dmesg | tail -3
 else
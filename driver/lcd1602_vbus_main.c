@@ -0,0 +1,225 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * Virtual I2C adapter with emulated LCD1602 backpacks
+ *
+ * Registers an i2c_adapter whose master_xfer feeds a PCF8574/HD44780 model
+ * (lcd1602_model.c) per address, and instantiates an "lcd1602" client on
+ * each, so the driver probes, writes, reads BF and is removed exactly as
+ * on real hardware, on any machine or VM without an I2C bus:
+ *
+ *   insmod lcd1602.ko && insmod lcd1602_vbus.ko addrs=0x27,0x3f
+ *
+ * What the panels show is in debugfs, for tests to assert on:
+ *
+ *   /sys/kernel/debug/lcd1602_vbus/<addr>/screen   the two visible rows
+ *   /sys/kernel/debug/lcd1602_vbus/<addr>/state    controller state and
+ *                                                   traffic counters
+ *
+ * Messages to any other address are NACKed. The model has no timing, so
+ * the driver's sleeps only cost time here.
+ */
+
+#include <linux/i2c.h>
+#include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#include <linux/err.h>
+#include "driver/lcd1602.h"
+#include "driver/lcd1602_encode.h"
+#include "driver/lcd1602_model.h"
+
+#define LCD_VBUS_PANELS 8
+
+static unsigned short addrs[LCD_VBUS_PANELS] = { 0x27 };
+static int naddrs = 1;
+module_param_array(addrs, ushort, &naddrs, 0444);
+MODULE_PARM_DESC(addrs, "addresses of the emulated backpacks (default 0x27)");
+
+struct lcd_vpanel {
+    struct lcd_model model;
+    struct i2c_client *client;
+    struct dentry *debugfs;
+};
+
+struct lcd_vbus {
+    struct i2c_adapter adapter;
+    struct mutex lock;      /* the models, against the debugfs readers */
+    struct lcd_vpanel panels[LCD_VBUS_PANELS];
+    unsigned int npanels;
+    struct dentry *debugfs;
+};
+
+static struct lcd_vbus *lcd_vbus;
+
+static struct lcd_vpanel *lcd_vbus_panel(struct lcd_vbus *vb, u16 addr) {
+    unsigned int i;
+
+    for (i = 0; i < vb->npanels; i++)
+        if (addrs[i] == addr)
+            return &vb->panels[i];
+    return NULL;
+}
+
+static int lcd_vbus_xfer(struct i2c_adapter *adapter, struct i2c_msg *msgs,
+                         int num) {
+    struct lcd_vbus *vb = i2c_get_adapdata(adapter);
+    struct lcd_vpanel *p;
+    int i;
+
+    mutex_lock(&vb->lock);
+    for (i = 0; i < num; i++) {
+        p = lcd_vbus_panel(vb, msgs[i].addr);
+        if (!p) {
+            mutex_unlock(&vb->lock);
+            return -ENXIO;
+        }
+        if (msgs[i].flags & I2C_M_RD)
+            lcd_model_read(&p->model, msgs[i].buf, msgs[i].len);
+        else
+            lcd_model_write(&p->model, msgs[i].buf, msgs[i].len);
+    }
+    mutex_unlock(&vb->lock);
+    return num;
+}
+
+static u32 lcd_vbus_functionality(struct i2c_adapter *adapter) {
+    return I2C_FUNC_I2C;
+}
+
+static const struct i2c_algorithm lcd_vbus_algo = {
+    .master_xfer = lcd_vbus_xfer,
+    .functionality = lcd_vbus_functionality,
+};
+
+/* the visible rows, anything unprintable (CGRAM codes) as '.' */
+static int lcd_vbus_screen_show(struct seq_file *m, void *v) {
+    struct lcd_vpanel *p = m->private;
+    unsigned int row, col;
+    u8 c;
+
+    mutex_lock(&lcd_vbus->lock);
+    for (row = 0; row < LCD_ROWS; row++) {
+        for (col = 0; col < LCD_COLS; col++) {
+            c = lcd_model_cell(&p->model, row, col);
+            seq_putc(m, c >= 0x20 && c < 0x7F ? c : '.');
+        }
+        seq_putc(m, '\n');
+    }
+    mutex_unlock(&lcd_vbus->lock);
+    return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(lcd_vbus_screen);
+
+static int lcd_vbus_state_show(struct seq_file *m, void *v) {
+    struct lcd_vpanel *p = m->private;
+    const struct lcd_model *md = &p->model;
+
+    mutex_lock(&lcd_vbus->lock);
+    seq_printf(m, "four_bit: %u\n", md->four_bit);
+    seq_printf(m, "two_line: %u\n", md->two_line);
+    seq_printf(m, "display_on: %u\n", md->display_on);
+    seq_printf(m, "backlight: %d\n", lcd_model_backlight(md));
+    seq_printf(m, "ac: 0x%02x%s\n", md->ac, md->cgram_selected ? " (cgram)" : "");
+    seq_printf(m, "shift: %u\n", md->shift);
+    seq_printf(m, "messages: %llu\n", md->messages);
+    seq_printf(m, "port_writes: %llu\n", md->port_writes);
+    seq_printf(m, "port_reads: %llu\n", md->port_reads);
+    seq_printf(m, "en_edges: %llu\n", md->en_edges);
+    seq_printf(m, "instructions: %llu\n", md->instructions);
+    seq_printf(m, "data_writes: %llu\n", md->data_writes);
+    mutex_unlock(&lcd_vbus->lock);
+    return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(lcd_vbus_state);
+
+static void lcd_vbus_unregister(struct lcd_vbus *vb) {
+    unsigned int i;
+
+    /* the driver clears each panel on remove, the models must still be up */
+    for (i = 0; i < vb->npanels; i++)
+        i2c_unregister_device(vb->panels[i].client);
+    debugfs_remove_recursive(vb->debugfs);
+    i2c_del_adapter(&vb->adapter);
+}
+
+static int __init lcd_vbus_init(void) {
+    static const struct lcd_pinmap map = LCD_PINMAP_DEFAULT;
+    struct i2c_board_info info = { I2C_BOARD_INFO("lcd1602", 0) };
+    struct lcd_vbus *vb;
+    struct lcd_vpanel *p;
+    char name[8];
+    unsigned int i, j;
+    int ret;
+
+    for (i = 0; i < naddrs; i++) {
+        for (j = 0; j < i && addrs[j] != addrs[i]; j++)
+            ;
+        if (addrs[i] < 0x08 || addrs[i] > 0x77 || j < i) {
+            pr_err("lcd1602_vbus: bad or duplicate address 0x%x\n", addrs[i]);
+            return -EINVAL;
+        }
+    }
+
+    vb = kzalloc(sizeof(*vb), GFP_KERNEL);
+    if (!vb)
+        return -ENOMEM;
+    mutex_init(&vb->lock);
+    vb->npanels = naddrs;
+    for (i = 0; i < vb->npanels; i++)
+        lcd_model_init(&vb->panels[i].model, &map);
+
+    vb->adapter.owner = THIS_MODULE;
+    vb->adapter.algo = &lcd_vbus_algo;
+    strscpy(vb->adapter.name, "lcd1602 virtual adapter",
+            sizeof(vb->adapter.name));
+    i2c_set_adapdata(&vb->adapter, vb);
+    ret = i2c_add_adapter(&vb->adapter);
+    if (ret) {
+        kfree(vb);
+        return ret;
+    }
+    lcd_vbus = vb;
+
+    vb->debugfs = debugfs_create_dir("lcd1602_vbus", NULL);
+    for (i = 0; i < vb->npanels; i++) {
+        p = &vb->panels[i];
+        snprintf(name, sizeof(name), "%02x", addrs[i]);
+        p->debugfs = debugfs_create_dir(name, vb->debugfs);
+        debugfs_create_file("screen", 0444, p->debugfs, p,
+                            &lcd_vbus_screen_fops);
+        debugfs_create_file("state", 0444, p->debugfs, p,
+                            &lcd_vbus_state_fops);
+    }
+
+    for (i = 0; i < vb->npanels; i++) {
+        info.addr = addrs[i];
+        p = &vb->panels[i];
+        p->client = i2c_new_client_device(&vb->adapter, &info);
+        if (IS_ERR(p->client)) {
+            ret = PTR_ERR(p->client);
+            dev_err(&vb->adapter.dev, "lcd1602 at 0x%02x failed: %d\n",
+                    addrs[i], ret);
+            vb->npanels = i;
+            lcd_vbus_unregister(vb);
+            kfree(vb);
+            return ret;
+        }
+    }
+    dev_info(&vb->adapter.dev, "%u emulated lcd1602 panel(s)\n", vb->npanels);
+    return 0;
+}
+
+static void __exit lcd_vbus_exit(void) {
+    lcd_vbus_unregister(lcd_vbus);
+    kfree(lcd_vbus);
+}
+
+module_init(lcd_vbus_init);
+module_exit(lcd_vbus_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_AUTHOR("PilotChalkanov");
+MODULE_DESCRIPTION("Virtual I2C adapter with emulated LCD1602 panels");
@@ -0,0 +1,161 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * Widgets rendered into DDRAM cells, see lcd1602_widget.h
+ */
+
+#include "driver/lcd1602_widget.h"
+
+unsigned int lcd_bar_steps(u32 value, u32 max, unsigned int width) {
+    unsigned int steps = width * LCD_BAR_STEPS_PER_CELL;
+    unsigned int i, n = 0;
+    u32 acc = 0;
+
+    if (value >= max)
+        return steps;
+    /*
+    floor(value * steps / max) by repeated addition, acc stays below max:
+    exact for the whole u32 range without a 64-bit division, which
+    32-bit kernels do not have, and steps is at most a few hundred
+    */
+    for (i = 0; i < steps; i++) {
+        if (acc >= max - value) {
+            acc -= max - value;
+            n++;
+        } else {
+            acc += value;
+        }
+    }
+    return n;
+}
+
+void lcd_bar_glyph(u8 *bitmap, unsigned int fill) {
+    u8 row = (u8)(0x1F << (LCD_BAR_STEPS_PER_CELL - fill)) & 0x1F;
+    unsigned int i;
+
+    for (i = 0; i < LCD_GLYPH_ROWS; i++)
+        bitmap[i] = row;
+}
+
+void lcd_bar_cells(u8 *cells, unsigned int width, unsigned int steps,
+                   u8 partial) {
+    unsigned int full = steps / LCD_BAR_STEPS_PER_CELL;
+    unsigned int i;
+
+    for (i = 0; i < width; i++) {
+        if (i < full)
+            cells[i] = LCD_BAR_FULL;
+        else if (i == full && steps % LCD_BAR_STEPS_PER_CELL)
+            cells[i] = partial;
+        else
+            cells[i] = LCD_BAR_EMPTY;
+    }
+}
+
+int lcd_bar_render(u8 *cells, struct lcd_glyph_cache *gc, const u8 *ddram,
+                   unsigned int row, unsigned int col, unsigned int width,
+                   u32 value, u32 max) {
+    unsigned int steps = lcd_bar_steps(value, max, width);
+    unsigned int fill = steps % LCD_BAR_STEPS_PER_CELL;
+    unsigned int start = row * LCD_DDRAM_COLS + col;
+    unsigned int end = start + width;
+    u8 bitmap[LCD_GLYPH_ROWS], in_use;
+    int code = LCD_BAR_EMPTY;
+
+    if (fill) {
+        lcd_bar_glyph(bitmap, fill);
+        in_use = lcd_glyph_in_use(ddram, start) |
+                 lcd_glyph_in_use(ddram + end,
+                                  LCD_ROWS * LCD_DDRAM_COLS - end);
+        code = lcd_glyph_get(gc, bitmap, in_use);
+        if (code < 0)
+            return code;
+    }
+    lcd_bar_cells(cells, width, steps, code);
+    return code;
+}
+
+void lcd_big_glyph(u8 *bitmap, enum lcd_big_glyph which) {
+    /* one bit per pixel row, row 0 is the top */
+    static const u8 rows[LCD_BIG_GLYPHS] = {
+        [LCD_BIG_TOP] = 0x07,
+        [LCD_BIG_BOTTOM] = 0xE0,
+        [LCD_BIG_BOTH] = 0xC3,
+    };
+    unsigned int i;
+
+    for (i = 0; i < LCD_GLYPH_ROWS; i++)
+        bitmap[i] = (rows[which] & (1U << i)) ? 0x1F : 0x00;
+}
+
+/*
+digit cells, F is the solid block, ' ' blank,
+T/B/M the top, bottom and both-bars glyphs
+*/
+static const char lcd_big_font[10][LCD_ROWS][LCD_BIG_DIGIT_COLS + 1] = {
+    { "FTF", "FBF" },
+    { "TF ", "BFB" },
+    { "MMF", "FBB" },
+    { "MMF", "BBF" },
+    { "FBF", "  F" },
+    { "FMM", "BBF" },
+    { "FMM", "FBF" },
+    { "TTF", "  F" },
+    { "FMF", "FBF" },
+    { "FMF", "BBF" },
+};
+
+static u8 lcd_big_cell(char c, const u8 *codes) {
+    switch (c) {
+    case 'F':
+        return LCD_BAR_FULL;
+    case 'T':
+        return codes[LCD_BIG_TOP];
+    case 'B':
+        return codes[LCD_BIG_BOTTOM];
+    case 'M':
+        return codes[LCD_BIG_BOTH];
+    default:
+        return ' ';
+    }
+}
+
+int lcd_big_render(u8 cells[LCD_ROWS][LCD_COLS], unsigned int width,
+                   const char *text, unsigned int len, const u8 *codes) {
+    unsigned int i, row, k, col = 0;
+    int digit = 0;          /* the previous column block was a digit */
+
+    for (i = 0; i < len; i++) {
+        if (text[i] == ':') {
+            if (col + 1 > width)
+                return -ENOSPC;
+            /* 0xA5 is the middle dot of ROM code A00 */
+            cells[0][col] = 0xA5;
+            cells[1][col] = 0xA5;
+            col++;
+            digit = 0;
+            continue;
+        }
+        if (text[i] != ' ' && (text[i] < '0' || text[i] > '9'))
+            return -EINVAL;
+        if (digit) {
+            if (col + 1 > width)
+                return -ENOSPC;
+            cells[0][col] = ' ';
+            cells[1][col] = ' ';
+            col++;
+        }
+        if (col + LCD_BIG_DIGIT_COLS > width)
+            return -ENOSPC;
+        for (row = 0; row < LCD_ROWS; row++)
+            for (k = 0; k < LCD_BIG_DIGIT_COLS; k++)
+                cells[row][col + k] = text[i] == ' ' ? ' ' :
+                    lcd_big_cell(lcd_big_font[text[i] - '0'][row][k], codes);
+        col += LCD_BIG_DIGIT_COLS;
+        digit = 1;
+    }
+    for (i = col; i < width; i++) {
+        cells[0][i] = ' ';
+        cells[1][i] = ' ';
+    }
+    return col;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * Widgets rendered into DDRAM cells
+ *
+ * Bar graph: each cell is 5 pixels wide, so a bar of width cells has
+ * 5 * width steps (80 on a full row). Full cells use the solid block
+ * 0xFF of the character ROM, the one partial cell a CGRAM glyph with
+ * 1-4 columns lit, and empty cells a space. Only one partial glyph is
+ * ever on a bar. Since the shadow only sends cells whose character
+ * changed, moving the bar rewrites the one or two cells around its end.
+ *
+ * Big digits: 3 columns by both rows, drawn from the ROM solid block and
+ * three CGRAM glyphs (top bar, bottom bar, both bars) that are pinned
+ * once and shared by every digit. Digits are one blank column apart,
+ * ':' is a single column, so "12:34" takes 15 columns. Again only the
+ * cells that differ go out, 12:34 -> 12:35 touches the last digit only.
+ */
+#ifndef DRIVER_LCD1602_WIDGET_H_
+#define DRIVER_LCD1602_WIDGET_H_
+
+#include "driver/lcd1602.h"
+#include "driver/lcd1602_glyph.h"
+
+#define LCD_BAR_STEPS_PER_CELL  5
+#define LCD_BAR_FULL            0xFF    /* solid block in ROM code A00 */
+#define LCD_BAR_EMPTY           ' '
+
+/* value out of max as bar steps, value is clamped to max, max > 0 */
+unsigned int lcd_bar_steps(u32 value, u32 max, unsigned int width);
+
+/* 5x8 bitmap with the left fill (1-4) columns lit */
+void lcd_bar_glyph(u8 *bitmap, unsigned int fill);
+
+/*
+ * Cells of a bar steps long, partial is the code showing the glyph of
+ * lcd_bar_glyph(steps % LCD_BAR_STEPS_PER_CELL) and unused if that is 0
+ */
+void lcd_bar_cells(u8 *cells, unsigned int width, unsigned int steps,
+                   u8 partial);
+
+/*
+ * Cells of a bar of width cells at row, col of ddram (LCD_ROWS rows of
+ * LCD_DDRAM_COLS), filled to value out of max, with the partial glyph
+ * looked up in gc. The bar's current cells do not count as showing their
+ * glyph, since they are all rewritten: a bar whose partial cell moves
+ * can take back its own slot. Returns the code of the partial cell,
+ * LCD_BAR_EMPTY if there is none, or -ENOSPC when no slot is free.
+ */
+int lcd_bar_render(u8 *cells, struct lcd_glyph_cache *gc, const u8 *ddram,
+                   unsigned int row, unsigned int col, unsigned int width,
+                   u32 value, u32 max);
+
+enum lcd_big_glyph {
+    LCD_BIG_TOP,        /* upper three pixel rows */
+    LCD_BIG_BOTTOM,     /* lower three pixel rows */
+    LCD_BIG_BOTH,       /* upper and lower two pixel rows */
+    LCD_BIG_GLYPHS,
+};
+
+#define LCD_BIG_DIGIT_COLS  3
+
+/* bitmap of one of the shared big-digit glyphs */
+void lcd_big_glyph(u8 *bitmap, enum lcd_big_glyph which);
+
+/*
+ * Render text ('0'-'9', ':' and ' ' as a blank digit) into the first width
+ * columns of both rows, padding with spaces; codes[] holds the character
+ * code of each enum lcd_big_glyph. Returns the columns used, -EINVAL for
+ * other characters or -ENOSPC if the text is wider than width.
+ */
+int lcd_big_render(u8 cells[LCD_ROWS][LCD_COLS], unsigned int width,
+                   const char *text, unsigned int len, const u8 *codes);
+
+#endif  // DRIVER_LCD1602_WIDGET_H_
@@ -0,0 +1,246 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * Userspace PCF8574/HD44780 model, see hd44780_sim.h
+ */
+
+#include "sim/hd44780_sim.h"
+
+namespace lcdsim {
+
+struct lcd_pinmap DefaultPinMap() {
+    struct lcd_pinmap map;
+
+    map.rs = 0;
+    map.rw = 1;
+    map.en = 2;
+    map.bl = 3;
+    map.data[0] = 4;
+    map.data[1] = 5;
+    map.data[2] = 6;
+    map.data[3] = 7;
+    return map;
+}
+
+void Hd44780::Reset() {
+    struct lcd_pinmap map = DefaultPinMap();
+
+    /* the model's own port is unused, Pcf8574 decodes the pins */
+    lcd_model_init(&model_, &map);
+    timed_ = false;
+    busy_until_ = 0;
+    last_fall_ = 0;
+    fell_ = false;
+    reset_steps_ = 0;
+    violations_.clear();
+}
+
+void Hd44780::EnableTiming(const Timing &timing) {
+    timed_ = true;
+    timing_ = timing;
+    busy_until_ = timing.power_on_ns;
+    fell_ = false;
+    reset_steps_ = 0;
+}
+
+void Hd44780::Write(bool rs, uint8_t nibble, uint64_t t_ns) {
+    bool eight_bit = !model_.four_bit;
+    int value;
+
+    /* BF cannot be polled before the interface is set, but waits still count */
+    if (busy(t_ns))
+        Violate(Violation::kBusy, t_ns, busy_until_ - t_ns);
+    value = lcd_model_latch(&model_, rs, nibble);
+    if (value >= 0 && timed_)
+        busy_until_ = t_ns + ExecTime(rs, value, eight_bit);
+}
+
+uint8_t Hd44780::ReadNibble(bool rs, uint64_t t_ns) const {
+    uint8_t nibble = lcd_model_drive(&model_, rs);
+
+    /* BF is D7, in the high nibble */
+    if (!rs && busy(t_ns) && !(model_.four_bit && model_.read_second))
+        nibble |= 0x08;
+    return nibble;
+}
+
+void Hd44780::CheckEnable(uint64_t rise_ns, uint64_t fall_ns,
+                          uint64_t stable_ns) {
+    if (!timed_)
+        return;
+    if (fall_ns - rise_ns < timing_.pulse_ns)
+        Violate(Violation::kPulseWidth, fall_ns,
+                timing_.pulse_ns - (fall_ns - rise_ns));
+    if (fell_ && fall_ns - last_fall_ < timing_.cycle_ns)
+        Violate(Violation::kCycleTime, fall_ns,
+                timing_.cycle_ns - (fall_ns - last_fall_));
+    if (fall_ns - stable_ns < timing_.setup_ns)
+        Violate(Violation::kSetup, fall_ns,
+                timing_.setup_ns - (fall_ns - stable_ns));
+    last_fall_ = fall_ns;
+    fell_ = true;
+}
+
+void Hd44780::CheckRise(uint64_t rise_ns, uint64_t addr_ns) {
+    if (!timed_)
+        return;
+    if (addr_ns + timing_.addr_setup_ns > rise_ns)
+        Violate(Violation::kAddressSetup, rise_ns,
+                addr_ns + timing_.addr_setup_ns - rise_ns);
+}
+
+void Hd44780::CheckHold(uint64_t t_ns) {
+    if (!timed_ || !fell_)
+        return;
+    if (t_ns - last_fall_ < timing_.hold_ns)
+        Violate(Violation::kHold, t_ns,
+                timing_.hold_ns - (t_ns - last_fall_));
+}
+
+void Hd44780::Violate(Violation::Kind kind, uint64_t t_ns,
+                      uint64_t short_ns) {
+    Violation v;
+
+    v.kind = kind;
+    v.t_ns = t_ns;
+    v.short_ns = short_ns;
+    violations_.push_back(v);
+}
+
+std::string Hd44780::Line(int row) const {
+    std::string line;
+    int col;
+
+    for (col = 0; col < kCols; col++)
+        line += static_cast<char>(Cell(row, col));
+    return line;
+}
+
+/*
+ * The reset sequence is three 8-bit function sets: the first needs 4.1ms,
+ * the second 100us, everything after that the usual execution time.
+ */
+uint64_t Hd44780::ExecTime(bool rs, uint8_t value, bool eight_bit) {
+    if (rs)
+        return timing_.exec_ns;
+    if (value == 0x01 || (value & 0xFE) == 0x02)
+        return timing_.slow_exec_ns;
+    if (eight_bit && (value & 0xE0) == 0x20) {
+        switch (reset_steps_++) {
+        case 0:
+            return timing_.init_long_ns;
+        case 1:
+            return timing_.init_short_ns;
+        }
+    }
+    return timing_.exec_ns;
+}
+
+Pcf8574::Pcf8574(Hd44780 *lcd, const struct lcd_pinmap &map)
+    : lcd_(lcd), map_(map), port_(0xFF), bus_hz_(0), now_ns_(0),
+      en_rise_ns_(0), stable_ns_(0), addr_ns_(0) {}
+
+uint8_t Pcf8574::DataNibble(uint8_t port) const {
+    uint8_t nibble = 0;
+    int i;
+
+    for (i = 0; i < 4; i++)
+        if (port & (1U << map_.data[i]))
+            nibble |= 1U << i;
+    return nibble;
+}
+
+void Pcf8574::WritePort(uint8_t port, uint64_t t_ns) {
+    uint8_t en = 1U << map_.en;
+    uint8_t bl = 1U << map_.bl;
+    uint8_t addr = 1U << map_.rs | 1U << map_.rw;
+    uint8_t changed = port ^ port_;
+    bool was_en = Pin(map_.en);
+
+    if (changed & ~(en | bl)) {
+        lcd_->CheckHold(t_ns);
+        stable_ns_ = t_ns;
+    }
+    if (changed & addr)
+        addr_ns_ = t_ns;
+    port_ = port;
+    stats_.port_writes++;
+    if (!was_en) {
+        if (Pin(map_.en)) {
+            en_rise_ns_ = t_ns;
+            lcd_->CheckRise(t_ns, addr_ns_);
+        }
+        return;
+    }
+    if (Pin(map_.en)) {
+        /* RS/RW have to stay put for the whole pulse */
+        if (changed & addr)
+            lcd_->CheckRise(en_rise_ns_, addr_ns_);
+        return;
+    }
+    /* EN fell: the controller latches RS, RW and the data lines */
+    stats_.en_edges++;
+    lcd_->CheckEnable(en_rise_ns_, t_ns, stable_ns_);
+    if (Pin(map_.rw))
+        lcd_->ReadDone(Pin(map_.rs));
+    else
+        lcd_->Write(Pin(map_.rs), DataNibble(port), t_ns);
+}
+
+uint8_t Pcf8574::ReadPort(uint64_t t_ns) {
+    uint8_t value = port_;
+    uint8_t nibble;
+    int i;
+
+    stats_.port_reads++;
+    if (!Pin(map_.rw) || !Pin(map_.en))
+        return value;
+    /* quasi-bidirectional: a pin written high reads what the LCD drives */
+    nibble = lcd_->ReadNibble(Pin(map_.rs), t_ns);
+    for (i = 0; i < 4; i++)
+        if (!(nibble & (1U << i)))
+            value &= ~(1U << map_.data[i]);
+    return value;
+}
+
+void Pcf8574::SetBusHz(uint32_t hz, const Timing &timing) {
+    bus_hz_ = hz;
+    now_ns_ = 0;
+    if (hz)
+        lcd_->EnableTiming(timing);
+}
+
+void Pcf8574::Write(const uint8_t *buf, size_t len) {
+    size_t i;
+
+    stats_.messages++;
+    if (!bus_hz_) {
+        for (i = 0; i < len; i++)
+            WritePort(buf[i]);
+        return;
+    }
+    /* the outputs change on the acknowledge of each data byte */
+    now_ns_ += ByteNs();
+    for (i = 0; i < len; i++) {
+        now_ns_ += ByteNs();
+        WritePort(buf[i], now_ns_);
+    }
+}
+
+void Pcf8574::Read(uint8_t *buf, size_t len) {
+    size_t i;
+
+    stats_.messages++;
+    if (!bus_hz_) {
+        for (i = 0; i < len; i++)
+            buf[i] = ReadPort();
+        return;
+    }
+    /* the inputs are sampled on the acknowledge before each data byte */
+    for (i = 0; i < len; i++) {
+        now_ns_ += ByteNs();
+        buf[i] = ReadPort(now_ns_);
+    }
+    now_ns_ += ByteNs();
+}
+
+}  // namespace lcdsim
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * Userspace model of a PCF8574 backpack driving an HD44780 controller
+ *
+ * Feed it the port bytes the driver would put on the bus and it tracks
+ * what the controller does with them: the 8-bit/4-bit interface state and
+ * nibble phase, DDRAM and CGRAM, the address counter, entry mode, display
+ * shift and the busy-flag/address read. The visible screen is the 16x2
+ * window onto DDRAM the display shift selects. Everything the driver sends
+ * is counted, so an optimisation can be measured in bytes on the wire
+ * without the hardware.
+ *
+ * The controller is driver/lcd1602_model.c, the model the virtual I2C
+ * adapter runs in the kernel; Hd44780 wraps it and adds the timing. By
+ * default the controller executes every instruction instantly and BF
+ * always reads 0. With timing enabled every port byte carries a timestamp,
+ * either given by the caller or taken from a modelled I2C clock, and each
+ * EN falling edge is checked against the datasheet minimums: EN pulse
+ * width and cycle time, data setup, the execution time of the previous
+ * instruction and the power-on and reset-sequence waits. Violations are
+ * recorded, not enforced: the byte is still executed, so a run shows every
+ * place the controller could have dropped one. BF reads back busy while an
+ * instruction is executing.
+ */
+#ifndef SIM_HD44780_SIM_H_
+#define SIM_HD44780_SIM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "driver/lcd1602_encode.h"
+#include "driver/lcd1602_model.h"
+}
+
+namespace lcdsim {
+
+/* the driver's default wiring, LCD_PINMAP_DEFAULT */
+struct lcd_pinmap DefaultPinMap();
+
+/* minimum times, HD44780U at 2.7-4.5V and the nominal 270kHz clock */
+struct Timing {
+    uint64_t pulse_ns = 450;            /* PWEH, EN high */
+    uint64_t cycle_ns = 1000;           /* tcycE, EN fall to EN fall */
+    uint64_t addr_setup_ns = 60;        /* tAS, RS/RW before EN rises */
+    uint64_t setup_ns = 195;            /* tDSW, data/RS/RW before EN falls */
+    uint64_t hold_ns = 20;              /* tAH/tH, RS/RW/data after EN falls */
+    uint64_t exec_ns = 37000;           /* most instructions, data writes */
+    uint64_t slow_exec_ns = 1520000;    /* clear, home */
+    uint64_t power_on_ns = 40000000;    /* Vcc at 2.7V to the first write */
+    uint64_t init_long_ns = 4100000;    /* after the first reset function set */
+    uint64_t init_short_ns = 100000;    /* after the second */
+};
+
+struct Violation {
+    enum Kind {
+        kPulseWidth,    /* EN high for less than pulse_ns */
+        kCycleTime,     /* EN falling edges less than cycle_ns apart */
+        kSetup,         /* data lines changed less than setup_ns before EN fell */
+        kBusy,          /* written while executing, or before power-on */
+        kAddressSetup,  /* RS/RW changed less than addr_setup_ns before EN
+                           rose, or while it was high */
+        kHold,          /* RS/RW/data changed less than hold_ns after EN fell */
+    };
+    Kind kind;
+    uint64_t t_ns;      /* the EN edge, or the change for kHold */
+    uint64_t short_ns;  /* by how much the minimum was missed */
+};
+
+class Hd44780 {
+ public:
+    static const int kRows = 2;
+    static const int kCols = 16;
+    static const int kLineLen = LCD_MODEL_LINE;
+    static const int kDdramSize = LCD_MODEL_DDRAM;
+    static const int kCgramSize = LCD_MODEL_CGRAM;
+
+    Hd44780() { Reset(); }
+
+    /* power-on internal reset: 8-bit, 1-line, display off, increment */
+    void Reset();
+
+    /* check timestamps from now on, power came up at t = 0 */
+    void EnableTiming(const Timing &timing = Timing());
+
+    /* EN falling edge with RW low, nibble on D7-D4 */
+    void Write(bool rs, uint8_t nibble, uint64_t t_ns = 0);
+
+    /* what the controller drives onto D7-D4 while EN is high with RW high */
+    uint8_t ReadNibble(bool rs, uint64_t t_ns = 0) const;
+
+    /* EN falling edge with RW high, ends the nibble ReadNibble() returned */
+    void ReadDone(bool rs) { lcd_model_read_done(&model_, rs); }
+
+    /* EN went high at rise_ns and fell at fall_ns, the data at stable_ns */
+    void CheckEnable(uint64_t rise_ns, uint64_t fall_ns, uint64_t stable_ns);
+
+    /* EN went high at rise_ns, RS/RW last changed at addr_ns */
+    void CheckRise(uint64_t rise_ns, uint64_t addr_ns);
+
+    /* RS/RW or the data lines changed at t_ns */
+    void CheckHold(uint64_t t_ns);
+
+    bool timed() const { return timed_; }
+    bool busy(uint64_t t_ns) const { return timed_ && t_ns < busy_until_; }
+    const std::vector<Violation> &violations() const { return violations_; }
+    void ClearViolations() { violations_.clear(); }
+
+    /* character code shown at a visible cell */
+    uint8_t Cell(int row, int col) const {
+        return lcd_model_cell(&model_, row, col);
+    }
+
+    /* the 16 visible character codes of a row */
+    std::string Line(int row) const;
+
+    /* the controller state, shared with the kernel's virtual adapter */
+    const struct lcd_model &model() const { return model_; }
+
+    uint8_t ddram(int addr) const { return model_.ddram[addr & 0x7F]; }
+    const uint8_t *cgram() const { return model_.cgram; }
+    int address_counter() const { return model_.ac; }
+    bool addressing_cgram() const { return model_.cgram_selected; }
+    bool four_bit() const { return model_.four_bit; }
+    bool two_line() const { return model_.two_line; }
+    bool display_on() const { return model_.display_on; }
+    int shift() const { return model_.shift; }
+    bool increment() const { return model_.increment; }
+
+    /* executed instructions and data bytes, reads included */
+    unsigned long instructions() const { return model_.instructions; }
+    unsigned long data_writes() const { return model_.data_writes; }
+
+ private:
+    uint64_t ExecTime(bool rs, uint8_t value, bool eight_bit);
+    void Violate(Violation::Kind kind, uint64_t t_ns, uint64_t short_ns);
+
+    struct lcd_model model_;
+
+    bool timed_;
+    Timing timing_;
+    uint64_t busy_until_;
+    uint64_t last_fall_;
+    bool fell_;                 /* last_fall_ is valid */
+    int reset_steps_;           /* 8-bit function sets seen, for their waits */
+    std::vector<Violation> violations_;
+};
+
+/* PCF8574 latching I2C bytes onto P0-P7, wired to an Hd44780 */
+class Pcf8574 {
+ public:
+    struct Stats {
+        unsigned long messages = 0;     /* I2C messages, write and read */
+        unsigned long port_writes = 0;  /* data bytes of write messages */
+        unsigned long port_reads = 0;   /* data bytes of read messages */
+        unsigned long en_edges = 0;     /* EN falling edges */
+
+        /* bytes on the wire, every message also carries its address byte */
+        unsigned long wire_bytes() const {
+            return messages + port_writes + port_reads;
+        }
+    };
+
+    explicit Pcf8574(Hd44780 *lcd,
+                     const struct lcd_pinmap &map = DefaultPinMap());
+
+    /* one byte of a write message, latched onto the pins at t_ns */
+    void WritePort(uint8_t port, uint64_t t_ns = 0);
+
+    /* one byte of a read message, the pins sampled at t_ns */
+    uint8_t ReadPort(uint64_t t_ns = 0);
+
+    /*
+     * Whole messages. With a bus clock set they are timed: the address
+     * byte and every data byte take 9 clocks, a port byte reaches the
+     * pins at the end of its own, and now_ns() advances past the message.
+     */
+    void Write(const uint8_t *buf, size_t len);
+    void Read(uint8_t *buf, size_t len);
+
+    /* model the I2C clock, and enable timing checks on the controller */
+    void SetBusHz(uint32_t hz, const Timing &timing = Timing());
+
+    /* the bus is idle, e.g. the driver sleeps */
+    void Idle(uint64_t ns) { now_ns_ += ns; }
+    uint64_t now_ns() const { return now_ns_; }
+
+    uint8_t port() const { return port_; }
+    bool backlight() const { return port_ & (1U << map_.bl); }
+    const Stats &stats() const { return stats_; }
+    void ResetStats() { stats_ = Stats(); }
+
+ private:
+    bool Pin(int pin) const { return port_ & (1U << pin); }
+    uint8_t DataNibble(uint8_t port) const;
+
+    uint64_t ByteNs() const { return 9000000000ULL / bus_hz_; }
+
+    Hd44780 *lcd_;
+    struct lcd_pinmap map_;
+    uint8_t port_;              /* last byte written, all high at power-on */
+    Stats stats_;
+    uint32_t bus_hz_;           /* 0: untimed */
+    uint64_t now_ns_;
+    uint64_t en_rise_ns_;       /* when EN last went high */
+    uint64_t stable_ns_;        /* when RS/RW/D4-D7 last changed */
+    uint64_t addr_ns_;          /* when RS/RW last changed */
+};
+
+}  // namespace lcdsim
+
+#endif  // SIM_HD44780_SIM_H_
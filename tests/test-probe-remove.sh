@@ -1,56 +1,100 @@
 #!/bin/bash
 
 # Test script for lcd1602 driver probe and remove
+#
+# Runs on any machine: lcd1602_vbus registers a virtual I2C adapter with an
+# emulated backpack at 0x27, the driver binds to it and the emulated screen
+# is read back from debugfs. Needs root (sudo) and debugfs.
 
 set -e
 
 DRIVER_DIR="../driver"
+VBUS_MODULE="lcd1602_vbus"
+ADDR="27"
+DEBUGFS="/sys/kernel/debug"
+SCREEN="${DEBUGFS}/${VBUS_MODULE}/${ADDR}/screen"
+
+fail() {
+    echo "✗ $*"
+    exit 1
+}
+
+# wait up to 5s for a condition, probe and init run asynchronously
+wait_for() {
+    local i
+
+    for i in $(seq 50); do
+        if eval "$1"; then
+            return 0
+        fi
+        sleep 0.1
+    done
+    return 1
+}
+
+screen_is() {
+    [ "$(sudo cat "${SCREEN}")" = "$(printf '%s\n%s' "$1" "$2")" ]
+}
 
 echo "===== Testing lcd1602 Driver Probe and Remove ====="
 echo ""
 
-# Test 1: Load the module
-echo "TEST 1: Loading the driver module..."
+# Test 1: Load the driver and the virtual adapter
+echo "TEST 1: Loading the driver on the virtual adapter..."
 echo "---"
 cd "${DRIVER_DIR}"
 bash lcd1602_load.sh
-LOAD_RESULT=$?
-
-if [ $LOAD_RESULT -eq 0 ]; then
-    echo "✓ Driver loaded successfully"
-
-    echo ""
-    echo "Verifying device files:"
-    echo "---"
-    ls -la /dev/lcd1602 2>/dev/null || echo "/dev/lcd1602 not found"
-    echo ""
-    echo "I2C device registration:"
-    ls -la /sys/bus/i2c/devices/ 2>/dev/null || echo "No I2C devices found"
-    echo ""
-    echo "Module directory:"
-    ls -la /sys/module/lcd1602/ 2>/dev/null || echo "Module sysfs not found"
-else
-    echo "✗ Failed to load driver"
-    exit 1
+if lsmod | grep -q "^${VBUS_MODULE} "; then
+    sudo rmmod "${VBUS_MODULE}"
 fi
+sudo insmod "./${VBUS_MODULE}.ko" "addrs=0x${ADDR}"
+
+BUS=""
+for adapter in /sys/bus/i2c/devices/i2c-*; do
+    if [ "$(cat "${adapter}/name")" = "lcd1602 virtual adapter" ]; then
+        BUS="${adapter##*/i2c-}"
+    fi
+done
+[ -n "${BUS}" ] || fail "virtual adapter not registered"
+DEVICE="/dev/lcd1602-${BUS}-${ADDR}"
+CLIENT="${BUS}-00${ADDR}"
+
+wait_for "[ -e ${DEVICE} ]" || fail "${DEVICE} not created"
+wait_for "sudo grep -q 'four_bit: 1' ${DEBUGFS}/${VBUS_MODULE}/${ADDR}/state" ||
+    fail "display not initialised"
+echo "✓ Probed on i2c-${BUS}, ${DEVICE}"
 
+# Test 2: Write through the device node and check the glass
 echo ""
-echo "Press Enter to continue with unload test..."
-read -r
+echo "TEST 2: Writing to ${DEVICE}..."
+echo "---"
+printf 'Hello\nvirtual bus' | sudo tee "${DEVICE}" > /dev/null
+wait_for "screen_is 'Hello           ' 'virtual bus     '" ||
+    fail "screen shows: $(sudo cat "${SCREEN}")"
+echo "✓ Text on the emulated screen"
+sudo cat "${DEBUGFS}/${VBUS_MODULE}/${ADDR}/state"
 
-# Test 2: Unload the module
+# Test 3: Remove and probe again by unbinding the client
 echo ""
-echo "TEST 2: Unloading the driver module..."
+echo "TEST 3: Unbinding and rebinding ${CLIENT}..."
 echo "---"
-bash lcd1602_unload.sh
-UNLOAD_RESULT=$?
+echo "${CLIENT}" | sudo tee /sys/bus/i2c/drivers/lcd1602/unbind > /dev/null
+wait_for "[ ! -e ${DEVICE} ]" || fail "${DEVICE} still there after remove"
+screen_is "                " "                " ||
+    fail "remove left: $(sudo cat "${SCREEN}")"
+echo "✓ Removed, screen cleared"
+echo "${CLIENT}" | sudo tee /sys/bus/i2c/drivers/lcd1602/bind > /dev/null
+wait_for "[ -e ${DEVICE} ]" || fail "${DEVICE} not created on rebind"
+echo "✓ Probed again"
 
-if [ $UNLOAD_RESULT -eq 0 ]; then
-    echo "✓ Driver unloaded successfully"
-else
-    echo "✗ Failed to unload driver"
-    exit 1
-fi
+# Test 4: Unload both modules
+echo ""
+echo "TEST 4: Unloading..."
+echo "---"
+sudo rmmod "${VBUS_MODULE}"
+[ ! -e "${DEVICE}" ] || fail "${DEVICE} still there after unload"
+bash lcd1602_unload.sh
+echo "✓ Driver unloaded successfully"
 
 echo ""
 echo "===== All Tests Passed ====="
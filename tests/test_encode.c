@@ -0,0 +1,240 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * Unit tests for the PCF8574 port-byte stream encoder
+ */
+
+#include <string.h>
+#include "driver/lcd1602_encode.h"
+#include "tests/check.h"
+
+static const struct lcd_pinmap default_map = LCD_PINMAP_DEFAULT;
+static struct lcd_encoder enc_bl, enc_dark;
+
+static void encoders_init(void) {
+    lcd_encoder_init(&enc_bl, &default_map, 1);
+    lcd_encoder_init(&enc_dark, &default_map, 0);
+}
+
+/* a message opens with a setup byte: RS settles before EN rises */
+static void test_byte_layout(void) {
+    struct lcd_stream s;
+    const u8 want[] = {
+        0x40 | LCD_RS | LCD_BL,
+        0x40 | LCD_RS | LCD_BL | LCD_EN, 0x40 | LCD_RS | LCD_BL,
+        0x10 | LCD_RS | LCD_BL | LCD_EN, 0x10 | LCD_RS | LCD_BL,
+    };
+
+    lcd_stream_init(&s, &enc_bl, 0);
+    CHECK(lcd_stream_byte(&s, 'A', 1) == 0);
+    CHECK(s.len == 1 + LCD_PORT_BYTES);
+    CHECK(memcmp(s.buf, want, sizeof(want)) == 0);
+}
+
+static void test_command_has_no_rs(void) {
+    struct lcd_stream s;
+
+    lcd_stream_init(&s, &enc_dark, 0);
+    CHECK(lcd_stream_byte(&s, LCD_SET_DDRAM | 0x40, 0) == 0);
+    CHECK(s.buf[0] == 0xC0);
+    CHECK(s.buf[1] == (0xC0 | LCD_EN));
+    CHECK(s.buf[2] == 0xC0);
+    CHECK(s.buf[3] == LCD_EN);
+    CHECK(s.buf[4] == 0x00);
+}
+
+/* one setup byte per RS change, none while RS stays */
+static void test_setup_on_rs_change(void) {
+    struct lcd_stream s;
+
+    lcd_stream_init(&s, &enc_bl, 0);
+    CHECK(lcd_stream_byte(&s, LCD_SET_DDRAM, 0) == 0);
+    CHECK(lcd_stream_byte(&s, LCD_CURSOR_SHIFT, 0) == 0);
+    CHECK_EQ(s.len, 1 + 2 * LCD_PORT_BYTES);
+    CHECK(lcd_stream_byte(&s, 'a', 1) == 0);
+    CHECK_EQ(s.buf[9], 0x60 | LCD_RS | LCD_BL);
+    CHECK_EQ(s.buf[10], 0x60 | LCD_RS | LCD_BL | LCD_EN);
+    CHECK(lcd_stream_byte(&s, 'b', 1) == 0);
+    CHECK_EQ(s.len, 2 + 4 * LCD_PORT_BYTES);
+
+    /* the next message starts from an unknown port state */
+    lcd_stream_reset(&s);
+    CHECK(lcd_stream_byte(&s, 'c', 1) == 0);
+    CHECK_EQ(s.len, 1 + LCD_PORT_BYTES);
+}
+
+static void test_init_nibble(void) {
+    struct lcd_stream s;
+
+    lcd_stream_init(&s, &enc_bl, 0);
+    CHECK(lcd_stream_nibble(&s, 0x03, 0) == 0);
+    CHECK(s.len == 3);
+    CHECK(s.buf[0] == (0x30 | LCD_BL));
+    CHECK(s.buf[1] == (0x30 | LCD_BL | LCD_EN));
+    CHECK(s.buf[2] == (0x30 | LCD_BL));
+}
+
+/* after power-on only EN drops, RW stays high so nothing is written */
+static void test_power_on(void) {
+    struct lcd_stream s;
+
+    lcd_stream_init(&s, &enc_bl, 0);
+    CHECK(lcd_stream_power_on(&s) == 0);
+    CHECK(lcd_stream_nibble(&s, 0x03, 0) == 0);
+    CHECK_EQ(s.len, 4);
+    CHECK_EQ(s.buf[0], 0xFF & ~LCD_EN);
+    CHECK_EQ(s.buf[1], 0x30 | LCD_BL);
+}
+
+/* the default table is the fixed layout: D4-D7 on P4-P7 */
+static void test_default_table_is_fixed_layout(void) {
+    unsigned int rs, val;
+    const u8 *seq;
+    u8 hi, lo;
+
+    for (rs = 0; rs < 2; rs++) {
+        for (val = 0; val < 256; val++) {
+            hi = (val & 0xF0) | (rs ? LCD_RS : 0) | LCD_BL;
+            lo = (u8)(val << 4) | (rs ? LCD_RS : 0) | LCD_BL;
+            seq = enc_bl.byte[rs][val];
+            CHECK_EQ(seq[0], hi | LCD_EN);
+            CHECK_EQ(seq[1], hi);
+            CHECK_EQ(seq[2], lo | LCD_EN);
+            CHECK_EQ(seq[3], lo);
+        }
+    }
+}
+
+/* a backpack with the control lines on the high pins and D4-D7 reversed */
+static void test_other_wiring(void) {
+    const struct lcd_pinmap map = {
+        .rs = 7, .rw = 6, .en = 5, .bl = 4, .data = { 3, 2, 1, 0 },
+    };
+    struct lcd_encoder enc;
+    struct lcd_stream s;
+
+    lcd_encoder_init(&enc, &map, 1);
+    lcd_stream_init(&s, &enc, 0);
+    /* 0x81: high nibble 8 is D7 on P0, low nibble 1 is D4 on P3 */
+    CHECK(lcd_stream_byte(&s, 0x81, 1) == 0);
+    CHECK_EQ(s.buf[0], 0x01 | 0x80 | 0x10);
+    CHECK_EQ(s.buf[1], 0x01 | 0x80 | 0x10 | 0x20);
+    CHECK_EQ(s.buf[2], 0x01 | 0x80 | 0x10);
+    CHECK_EQ(s.buf[3], 0x08 | 0x80 | 0x10 | 0x20);
+    CHECK_EQ(s.buf[4], 0x08 | 0x80 | 0x10);
+}
+
+static void test_pinmap_checks(void) {
+    const u32 swapped[LCD_PINMAP_LEN] = { 7, 6, 5, 4, 3, 2, 1, 0 };
+    const u32 shared[LCD_PINMAP_LEN] = { 0, 1, 2, 3, 4, 5, 6, 0 };
+    const u32 range[LCD_PINMAP_LEN] = { 0, 1, 2, 3, 4, 5, 6, 8 };
+    struct lcd_pinmap map;
+    struct lcd_encoder enc;
+
+    CHECK_EQ(lcd_pinmap_set(&map, shared), -EINVAL);
+    CHECK_EQ(lcd_pinmap_set(&map, range), -EINVAL);
+    CHECK_EQ(lcd_pinmap_set(&map, swapped), 0);
+    CHECK_EQ(map.en, 5);
+    CHECK_EQ(map.data[3], 0);
+
+    /* busy-flag reads release D4-D7 and decode them back */
+    lcd_encoder_init(&enc, &map, 1);
+    CHECK_EQ(enc.read_port, 0x0F | 0x40 | 0x10);
+    CHECK_EQ(lcd_encoder_decode(&enc, 0x01), 0x08);
+    CHECK_EQ(lcd_encoder_decode(&enc_bl, 0x80 | LCD_BL), 0x08);
+}
+
+static void test_full_frame_fits_one_message(void) {
+    /* no padding, 1MHz, and the fastest clock lcd_bus_hz() accepts */
+    static const u8 pads[] = { 0, 3, LCD_PAD_MAX };
+    struct lcd_stream s;
+    unsigned int i;
+    int row, col;
+
+    for (i = 0; i < sizeof(pads); i++) {
+        lcd_stream_init(&s, &enc_bl, pads[i]);
+        for (row = 0; row < LCD_ROWS; row++) {
+            CHECK(lcd_stream_byte(&s, LCD_SET_DDRAM | LCD_ROW_ADDR(row),
+                                  0) == 0);
+            for (col = 0; col < LCD_COLS; col++)
+                CHECK(lcd_stream_byte(&s, 'x', 1) == 0);
+        }
+        CHECK(lcd_stream_space(&s) == 0);
+        CHECK(lcd_stream_byte(&s, 'x', 1) == -ENOSPC);
+        lcd_stream_reset(&s);
+        CHECK(s.len == 0);
+    }
+}
+
+/* an adapter's max_write_len splits frames into more messages */
+static void test_stream_limit(void) {
+    struct lcd_stream s;
+
+    lcd_stream_init(&s, &enc_bl, 0);
+    lcd_stream_limit(&s, 11);
+    lcd_stream_limit(&s, 1000);
+    CHECK_EQ(s.max, 11);
+    CHECK_EQ(lcd_stream_space(&s), 2);
+    CHECK(lcd_stream_byte(&s, 'a', 1) == 0);
+    CHECK(lcd_stream_byte(&s, 'b', 1) == 0);
+    CHECK(lcd_stream_byte(&s, 'c', 1) == -ENOSPC);
+    /* a nibble with RS changed needs its setup byte too */
+    CHECK(lcd_stream_nibble(&s, 0x3, 0) == -ENOSPC);
+    CHECK(lcd_stream_nibble(&s, 0x3, 1) == 0);
+    CHECK_EQ(s.len, 11);
+}
+
+static void test_padding_keeps_port_state(void) {
+    struct lcd_stream s;
+    unsigned int i;
+
+    lcd_stream_init(&s, &enc_bl, 3);
+    CHECK_EQ(lcd_stream_byte_cost(&s), 7);
+    CHECK(lcd_stream_byte(&s, 'A', 1) == 0);
+    CHECK_EQ(s.len, 1 + 7);
+    for (i = 5; i < 8; i++)
+        CHECK_EQ(s.buf[i], 0x10 | LCD_RS | LCD_BL);
+}
+
+static void test_timing_plan(void) {
+    struct lcd_timing t;
+
+    /* standard mode: every wait but the long init one is covered */
+    lcd_timing_init(&t, 100000);
+    CHECK_EQ(t.byte_ns, 90000);
+    CHECK_EQ(t.pad_bytes, 0);
+    CHECK_EQ(t.init_short_us, 0);
+    CHECK_EQ(t.slow_cmd_us, 1700 - 180);
+    CHECK_EQ(t.init_long_us, 4500 - 180);
+
+    lcd_timing_init(&t, 400000);
+    CHECK_EQ(t.pad_bytes, 0);
+    CHECK_EQ(t.init_short_us, 150 - 45);
+
+    /* fast-mode plus: 18us between EN edges is too short for 37us */
+    lcd_timing_init(&t, 1000000);
+    CHECK_EQ(t.pad_bytes, 3);
+
+    /* the fastest clock lcd_bus_hz() accepts still gives a sane plan */
+    lcd_timing_init(&t, LCD_BUS_HZ_MAX);
+    CHECK_EQ(t.byte_ns, 1800);
+    CHECK_EQ(t.pad_bytes, 21);
+    CHECK_EQ(t.pad_bytes, LCD_PAD_MAX);
+    CHECK_EQ(t.init_short_us, 147);
+}
+
+int main(void) {
+    encoders_init();
+    test_byte_layout();
+    test_command_has_no_rs();
+    test_setup_on_rs_change();
+    test_init_nibble();
+    test_power_on();
+    test_default_table_is_fixed_layout();
+    test_other_wiring();
+    test_pinmap_checks();
+    test_full_frame_fits_one_message();
+    test_stream_limit();
+    test_padding_keeps_port_state();
+    test_timing_plan();
+    return check_report();
+}
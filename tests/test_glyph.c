@@ -0,0 +1,151 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * Unit tests for the CGRAM glyph cache
+ */
+
+#include <string.h>
+#include "driver/lcd1602_glyph.h"
+#include "tests/check.h"
+
+/* a distinct bitmap per id */
+static const u8 *glyph(unsigned int id) {
+    static u8 bm[LCD_GLYPH_ROWS];
+
+    memset(bm, 0, sizeof(bm));
+    bm[id % LCD_GLYPH_ROWS] = 1 + id / LCD_GLYPH_ROWS;
+    return bm;
+}
+
+static void test_hit_needs_no_upload(void) {
+    struct lcd_glyph_cache gc;
+    int slot;
+
+    lcd_glyph_cache_init(&gc);
+    slot = lcd_glyph_get(&gc, glyph(1), 0);
+    CHECK_EQ(slot, 0);
+    CHECK_EQ(gc.upload, 0x01);
+    gc.upload = 0;
+
+    CHECK_EQ(lcd_glyph_get(&gc, glyph(1), 0), slot);
+    CHECK_EQ(gc.upload, 0);
+}
+
+static void test_only_pixel_bits_count(void) {
+    struct lcd_glyph_cache gc;
+    u8 bm[LCD_GLYPH_ROWS] = { 0x1F, 0, 0, 0, 0, 0, 0, 0 };
+
+    lcd_glyph_cache_init(&gc);
+    CHECK_EQ(lcd_glyph_get(&gc, bm, 0), 0);
+    bm[0] = 0xFF;
+    CHECK_EQ(lcd_glyph_get(&gc, bm, 0), 0);
+}
+
+static void test_evicts_least_recently_displayed(void) {
+    struct lcd_glyph_cache gc;
+    unsigned int i;
+
+    lcd_glyph_cache_init(&gc);
+    for (i = 0; i < LCD_CGRAM_SLOTS; i++)
+        CHECK_EQ(lcd_glyph_get(&gc, glyph(i), 0), (int)i);
+    gc.upload = 0;
+
+    /* slot 0 is still on the glass, so slot 1 is the oldest candidate */
+    CHECK_EQ(lcd_glyph_get(&gc, glyph(100), 0x01), 1);
+    CHECK_EQ(gc.upload, 0x02);
+
+    /*
+    being displayed refreshed slot 0, and looking glyph 2 up again
+    refreshes slot 2, so slots 3 and 4 go next
+    */
+    CHECK_EQ(lcd_glyph_get(&gc, glyph(2), 0), 2);
+    CHECK_EQ(lcd_glyph_get(&gc, glyph(101), 0), 3);
+    CHECK_EQ(lcd_glyph_get(&gc, glyph(102), 0), 4);
+}
+
+static void test_displayed_and_pinned_slots_stay(void) {
+    struct lcd_glyph_cache gc;
+    unsigned int i;
+
+    lcd_glyph_cache_init(&gc);
+    for (i = 0; i < LCD_CGRAM_SLOTS; i++)
+        lcd_glyph_get(&gc, glyph(i), 0);
+    gc.slots[7].pinned = 1;
+    CHECK_EQ(lcd_glyph_get(&gc, glyph(100), 0x7F), -ENOSPC);
+    CHECK_EQ(lcd_glyph_get(&gc, glyph(100), 0x3F), 6);
+}
+
+static void test_reserved_slot_is_private(void) {
+    struct lcd_glyph_cache gc;
+    int slot;
+
+    lcd_glyph_cache_init(&gc);
+    slot = lcd_glyph_reserve(&gc, glyph(1), 0);
+    CHECK_EQ(slot, 0);
+    CHECK_EQ(gc.upload, 0x01);
+    gc.upload = 0;
+
+    /* the same bitmap gets a slot of its own, not the animated one */
+    CHECK_EQ(lcd_glyph_get(&gc, glyph(1), 0), 1);
+    gc.upload = 0;
+
+    /* only a changed frame costs an upload */
+    lcd_glyph_set(&gc, slot, glyph(1));
+    CHECK_EQ(gc.upload, 0);
+    lcd_glyph_set(&gc, slot, glyph(2));
+    CHECK_EQ(gc.upload, 0x01);
+
+    /* after release its last frame is an ordinary cached glyph */
+    lcd_glyph_release(&gc, slot);
+    CHECK_EQ(lcd_glyph_get(&gc, glyph(2), 0), slot);
+}
+
+static void test_reserve_never_steals_displayed(void) {
+    struct lcd_glyph_cache gc;
+    unsigned int i;
+
+    lcd_glyph_cache_init(&gc);
+    for (i = 0; i < LCD_CGRAM_SLOTS - 1; i++)
+        CHECK_EQ(lcd_glyph_reserve(&gc, glyph(i), 0), (int)i);
+    CHECK_EQ(lcd_glyph_reserve(&gc, glyph(9), 0x80), -ENOSPC);
+    CHECK_EQ(lcd_glyph_get(&gc, glyph(9), 0x80), -ENOSPC);
+    CHECK_EQ(lcd_glyph_reserve(&gc, glyph(9), 0), 7);
+}
+
+static void test_pinned_glyph_is_shared(void) {
+    struct lcd_glyph_cache gc;
+    unsigned int i;
+    int slot;
+
+    lcd_glyph_cache_init(&gc);
+    slot = lcd_glyph_pin(&gc, glyph(1), 0);
+    for (i = 0; i < 2 * LCD_CGRAM_SLOTS; i++)
+        CHECK(lcd_glyph_get(&gc, glyph(100 + i), 0) != slot);
+    /* still resident, a lookup of the same bitmap shares it */
+    CHECK_EQ(lcd_glyph_get(&gc, glyph(1), 0), slot);
+
+    /* released, it takes its turn in the LRU again */
+    lcd_glyph_release(&gc, slot);
+    for (i = 0; i < LCD_CGRAM_SLOTS; i++)
+        if (lcd_glyph_get(&gc, glyph(200 + i), 0) == slot)
+            break;
+    CHECK(i < LCD_CGRAM_SLOTS);
+}
+
+static void test_in_use_scan(void) {
+    const u8 cells[] = { 'a', 0x00, ' ', 0x0B, 0xFF, 0x10 };
+
+    /* code 11 shows slot 3 */
+    CHECK_EQ(lcd_glyph_in_use(cells, sizeof(cells)), 0x09);
+}
+
+int main(void) {
+    test_hit_needs_no_upload();
+    test_only_pixel_bits_count();
+    test_evicts_least_recently_displayed();
+    test_displayed_and_pinned_slots_stay();
+    test_reserved_slot_is_private();
+    test_pinned_glyph_is_shared();
+    test_reserve_never_steals_displayed();
+    test_in_use_scan();
+    return check_report();
+}
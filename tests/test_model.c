@@ -0,0 +1,167 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * Unit tests for the PCF8574/HD44780 model behind the virtual adapter
+ */
+
+#include <string.h>
+#include "driver/lcd1602_encode.h"
+#include "driver/lcd1602_exec.h"
+#include "driver/lcd1602_model.h"
+#include "tests/check.h"
+
+static const struct lcd_pinmap default_map = LCD_PINMAP_DEFAULT;
+static struct lcd_timing timing;
+
+/* the model behind lcd_exec, as the virtual adapter sees the driver */
+static int model_xfer(void *ctx, const u8 *buf, unsigned int len) {
+    lcd_model_write(ctx, buf, len);
+    return 0;
+}
+
+/* the model does not keep time */
+static void model_sleep(void *ctx, unsigned int us) {
+    (void)ctx;
+    (void)us;
+}
+
+static const struct lcd_exec_ops model_ops = {
+    .xfer = model_xfer,
+    .sleep_us = model_sleep,
+};
+
+static void setup(struct lcd_model *m, struct lcd_encoder *enc,
+                  struct lcd_exec *x, const struct lcd_pinmap *map,
+                  u8 backlight) {
+    lcd_model_init(m, map);
+    lcd_encoder_init(enc, map, backlight);
+    lcd_exec_init(x, &model_ops, m, enc, &timing);
+}
+
+/* lcd_init_display(), cold */
+static void cold_init(struct lcd_exec *x) {
+    CHECK_EQ(lcd_exec_reset(x), 0);
+    CHECK_EQ(lcd_exec_configure(x), 0);
+}
+
+static void text(struct lcd_exec *x, const char *t) {
+    while (*t)
+        lcd_exec_emit(x, *t++, 1);
+    lcd_exec_xfer(x);
+}
+
+static void row(const struct lcd_model *m, unsigned int r, char *out) {
+    unsigned int col;
+
+    for (col = 0; col < LCD_COLS; col++)
+        out[col] = lcd_model_cell(m, r, col);
+    out[LCD_COLS] = '\0';
+}
+
+static void test_init_and_text(void) {
+    struct lcd_model m;
+    struct lcd_encoder enc;
+    struct lcd_exec x;
+    char line[LCD_COLS + 1];
+
+    setup(&m, &enc, &x, &default_map, 1);
+    CHECK(!m.four_bit);
+    cold_init(&x);
+    CHECK(m.four_bit);
+    CHECK(m.two_line);
+    CHECK(m.display_on);
+    CHECK(lcd_model_backlight(&m));
+    CHECK_EQ(x.ac, 0);
+
+    text(&x, "Hello");
+    lcd_exec_command(&x, LCD_SET_DDRAM | (LCD_ROW_ADDR(1) + 11));
+    text(&x, "world");
+    row(&m, 0, line);
+    CHECK(strcmp(line, "Hello           ") == 0);
+    row(&m, 1, line);
+    CHECK(strcmp(line, "           world") == 0);
+    CHECK_EQ(m.ac, 0x50);
+    CHECK_EQ(m.data_writes, 10);
+}
+
+/* the wiring comes from the pin map, like the driver's encoder */
+static void test_pinmap(void) {
+    static const u32 pins[LCD_PINMAP_LEN] = { 6, 5, 4, 7, 0, 1, 2, 3 };
+    struct lcd_pinmap map;
+    struct lcd_model m;
+    struct lcd_encoder enc;
+    struct lcd_exec x;
+
+    CHECK_EQ(lcd_pinmap_set(&map, pins), 0);
+    setup(&m, &enc, &x, &map, 0);
+    cold_init(&x);
+    text(&x, "pcf");
+    CHECK_EQ(lcd_model_cell(&m, 0, 2), 'f');
+    CHECK(!lcd_model_backlight(&m));
+}
+
+/* lcd_read_bf_ac(): EN high, read, EN high, read, EN low */
+static void test_read_bf_ac(void) {
+    struct lcd_model m;
+    struct lcd_encoder enc;
+    struct lcd_exec x;
+    u8 en_hi[2], en_lo[1], hi, lo;
+
+    setup(&m, &enc, &x, &default_map, 1);
+    cold_init(&x);
+    lcd_exec_command(&x, LCD_SET_DDRAM | 0x45);
+    lcd_exec_xfer(&x);
+
+    en_hi[0] = enc.read_port;
+    en_hi[1] = enc.read_port | enc.en;
+    en_lo[0] = enc.read_port;
+    lcd_model_write(&m, en_hi, sizeof(en_hi));
+    lcd_model_read(&m, &hi, 1);
+    lcd_model_write(&m, en_hi, sizeof(en_hi));
+    lcd_model_read(&m, &lo, 1);
+    lcd_model_write(&m, en_lo, sizeof(en_lo));
+    CHECK_EQ(lcd_encoder_decode(&enc, hi) << 4 | lcd_encoder_decode(&enc, lo),
+             0x45);
+    CHECK_EQ(m.port_reads, 2);
+
+    /* the read left the nibble phase alone */
+    text(&x, "z");
+    CHECK_EQ(m.ddram[0x45], 'z');
+}
+
+static void test_shift_and_cgram(void) {
+    struct lcd_model m;
+    struct lcd_encoder enc;
+    struct lcd_exec x;
+    unsigned int i;
+
+    setup(&m, &enc, &x, &default_map, 1);
+    cold_init(&x);
+    lcd_exec_command(&x, LCD_SET_DDRAM | LCD_COLS);
+    text(&x, "page1");
+    for (i = 0; i < LCD_COLS; i++)
+        lcd_exec_command(&x, LCD_CURSOR_SHIFT | LCD_DISPLAY_MOVE |
+                         LCD_MOVE_LEFT);
+    lcd_exec_xfer(&x);
+    CHECK_EQ(m.shift, LCD_COLS);
+    CHECK_EQ(lcd_model_cell(&m, 0, 4), '1');
+
+    lcd_exec_command(&x, LCD_SET_CGRAM | 8);
+    for (i = 0; i < 8; i++)
+        lcd_exec_emit(&x, 0x10 + i, 1);
+    lcd_exec_xfer(&x);
+    CHECK_EQ(m.cgram[15], 0x17);
+    CHECK(m.cgram_selected);
+
+    lcd_exec_command(&x, LCD_HOME);
+    CHECK_EQ(m.shift, 0);
+    CHECK(!m.cgram_selected);
+}
+
+int main(void) {
+    lcd_timing_init(&timing, 100000);
+    test_init_and_text();
+    test_pinmap();
+    test_read_bf_ac();
+    test_shift_and_cgram();
+    return check_report();
+}
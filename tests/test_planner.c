@@ -0,0 +1,296 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * Unit tests for the flush planner: byte counts on a corpus of frame
+ * transitions, and optimality against a brute-force reference
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "driver/lcd1602_encode.h"
+#include "driver/lcd1602_planner.h"
+#include "tests/check.h"
+
+/* one I2C byte at 100kHz and 1MHz */
+#define BYTE_NS_100K  90000
+#define BYTE_NS_1M    9000
+
+/* clear plus 1.7ms of wait at 100kHz, in port bytes */
+#define CLEAR_100K    (4 + 19)
+
+/* glass shows old (visible part, rest spaces), target is new */
+static void make_frame(struct lcd_shadow *sh, const char *old0,
+                       const char *old1, const char *new0, const char *new1) {
+    const char *old[LCD_ROWS] = { old0, old1 };
+    const char *cur[LCD_ROWS] = { new0, new1 };
+    unsigned int row, col;
+    u8 c;
+
+    memset(sh->ddram, ' ', sizeof(sh->ddram));
+    memset(sh->dirty, 0, sizeof(sh->dirty));
+    for (row = 0; row < LCD_ROWS; row++) {
+        memcpy(sh->ddram[row], old[row], strlen(old[row]));
+        for (col = 0; col < strlen(cur[row]); col++) {
+            c = cur[row][col];
+            if (sh->ddram[row][col] != c) {
+                sh->ddram[row][col] = c;
+                sh->dirty[row] |= BIT_ULL(col);
+            }
+        }
+    }
+}
+
+/*
+run the plan against a model of the glass that starts as old and check
+that it ends up as the shadow, at exactly the cost the plan claims
+*/
+static void check_plan_executes(const struct lcd_plan *plan,
+                                const struct lcd_shadow *sh,
+                                const struct lcd_cost_model *cm, int ac) {
+    u8 glass[LCD_ROWS][LCD_DDRAM_COLS];
+    unsigned int i, n, row, col, cost = 0;
+    const struct lcd_op *op;
+
+    memcpy(glass, sh->ddram, sizeof(glass));
+    for (row = 0; row < LCD_ROWS; row++)
+        for (col = 0; col < LCD_DDRAM_COLS; col++)
+            if (sh->dirty[row] & BIT_ULL(col))
+                glass[row][col] = '?';
+
+    for (i = 0; i < plan->nops; i++) {
+        op = &plan->ops[i];
+        switch (op->type) {
+        case LCD_OP_CLEAR:
+            memset(glass, ' ', sizeof(glass));
+            ac = 0;
+            cost += cm->clear_cost;
+            break;
+        case LCD_OP_ADDR:
+            ac = LCD_ROW_ADDR(op->row) + op->col;
+            cost += cm->byte_cost;
+            break;
+        case LCD_OP_DATA:
+            CHECK_EQ(ac, LCD_ROW_ADDR(op->row) + op->col);
+            for (n = 0; n < op->len; n++) {
+                glass[op->row][op->col + n] = sh->ddram[op->row][op->col + n];
+                ac = lcd_ac_next(op->row, op->col + n);
+            }
+            cost += op->len * cm->byte_cost;
+            break;
+        case LCD_OP_SHIFT:
+        case LCD_OP_HOME:
+            /* shift plans are checked on their own */
+            break;
+        }
+    }
+    CHECK(memcmp(glass, sh->ddram, sizeof(glass)) == 0);
+    CHECK_EQ(cost, plan->cost);
+    CHECK_EQ(ac, plan->ac);
+}
+
+static unsigned int plan_cost(const struct lcd_shadow *sh, int ac,
+                              unsigned int byte_ns) {
+    struct lcd_cost_model cm;
+    struct lcd_plan plan;
+
+    lcd_cost_model_init(&cm, LCD_PORT_BYTES, byte_ns);
+    lcd_plan_frame(&plan, sh, ac, &cm);
+    check_plan_executes(&plan, sh, &cm, ac);
+    return plan.cost;
+}
+
+static void test_cost_model(void) {
+    struct lcd_cost_model cm;
+
+    lcd_cost_model_init(&cm, LCD_PORT_BYTES, BYTE_NS_100K);
+    CHECK_EQ(cm.byte_cost, 4);
+    CHECK_EQ(cm.clear_cost, CLEAR_100K);
+}
+
+static void test_corpus(void) {
+    static const struct {
+        const char *name;
+        const char *old0, *old1, *new0, *new1;
+        int ac;
+        unsigned int byte_ns;
+        unsigned int bytes;
+    } corpus[] = {
+        { "unchanged", "CPU 12%", "MEM 40%", "CPU 12%", "MEM 40%",
+          LCD_AC_UNKNOWN, BYTE_NS_100K, 0 },
+        { "one cell", "CPU 12%", "", "CPU 13%", "",
+          LCD_AC_UNKNOWN, BYTE_NS_100K, 8 },
+        { "one cell at cursor", "CPU 12%", "", "CPU 13%", "",
+          5, BYTE_NS_100K, 4 },
+        { "cursor one cell early", "CPU 12%", "", "CPU 13%", "",
+          4, BYTE_NS_100K, 8 },
+        { "gap of one written through", "12:34:56", "", "12:35:57", "",
+          LCD_AC_UNKNOWN, BYTE_NS_100K, 4 * 4 },
+        { "gap of two re-addressed", "ab--cd", "", "aX--Yd", "",
+          LCD_AC_UNKNOWN, BYTE_NS_100K, 2 * 8 },
+        { "both rows", "CPU 12%", "MEM 40%", "CPU 13%", "MEM 41%",
+          LCD_AC_UNKNOWN, BYTE_NS_100K, 2 * 8 },
+        { "cursor in second row", "A", "B", "X", "Y",
+          0x40, BYTE_NS_100K, 4 + 8 },
+        { "dashboard tick", "T 21.4C  H 40%", "up 3d 04:12:09",
+          "T 21.5C  H 41%", "up 3d 04:12:10",
+          LCD_AC_UNKNOWN, BYTE_NS_100K, 8 + 8 + 12 },
+        { "full screen blanked, clear wins", "0123456789abcdef",
+          "fedcba9876543210", "                ", "                ",
+          LCD_AC_UNKNOWN, BYTE_NS_100K, CLEAR_100K },
+        { "mostly blank, clear wins", "0123456789abcdef",
+          "fedcba9876543210", "Hi              ", "                ",
+          LCD_AC_UNKNOWN, BYTE_NS_100K, CLEAR_100K + 8 },
+        { "full screen blanked on a fast bus", "0123456789abcdef",
+          "fedcba9876543210", "                ", "                ",
+          LCD_AC_UNKNOWN, BYTE_NS_1M, 2 * (4 + 16 * 4) },
+        { "full rewrite", "0123456789abcdef", "fedcba9876543210",
+          "abcdefghijklmnop", "ponmlkjihgfedcba",
+          LCD_AC_UNKNOWN, BYTE_NS_100K, 2 * (4 + 16 * 4) },
+    };
+    struct lcd_shadow sh;
+    unsigned int i, got;
+
+    for (i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++) {
+        make_frame(&sh, corpus[i].old0, corpus[i].old1,
+                   corpus[i].new0, corpus[i].new1);
+        got = plan_cost(&sh, corpus[i].ac, corpus[i].byte_ns);
+        if (got != corpus[i].bytes)
+            fprintf(stderr, "corpus '%s': %u bytes, want %u\n",
+                    corpus[i].name, got, corpus[i].bytes);
+        CHECK_EQ(got, corpus[i].bytes);
+    }
+}
+
+static void test_never_homes(void) {
+    struct lcd_cost_model cm;
+    struct lcd_plan plan;
+    struct lcd_shadow sh;
+
+    /* rewriting from the top-left corner costs one Set-DDRAM, not a home */
+    make_frame(&sh, "x", "", "y", "");
+    lcd_cost_model_init(&cm, LCD_PORT_BYTES, BYTE_NS_100K);
+    lcd_plan_frame(&plan, &sh, LCD_AC_UNKNOWN, &cm);
+    CHECK_EQ(plan.nops, 2);
+    CHECK_EQ(plan.ops[0].type, LCD_OP_ADDR);
+    CHECK_EQ(plan.ops[1].type, LCD_OP_DATA);
+}
+
+static void plan_shift(struct lcd_plan *plan, int shift, int want,
+                       unsigned int byte_ns) {
+    struct lcd_cost_model cm;
+    struct lcd_shadow sh;
+
+    make_frame(&sh, "", "", "", "");
+    lcd_cost_model_init(&cm, LCD_PORT_BYTES, byte_ns);
+    lcd_plan_frame(plan, &sh, LCD_AC_UNKNOWN, &cm);
+    lcd_plan_shift(plan, shift, want, &cm);
+    CHECK_EQ(plan->shift, want);
+}
+
+static void test_page_flips(void) {
+    struct lcd_plan plan;
+
+    /* nothing to do */
+    plan_shift(&plan, LCD_COLS, LCD_COLS, BYTE_NS_100K);
+    CHECK_EQ(plan.nops, 0);
+    CHECK_EQ(plan.cost, 0);
+
+    /* page 0 -> 1: sixteen left shifts, no home can help */
+    plan_shift(&plan, 0, LCD_COLS, BYTE_NS_100K);
+    CHECK_EQ(plan.nops, 1);
+    CHECK_EQ(plan.ops[0].type, LCD_OP_SHIFT);
+    CHECK_EQ(plan.ops[0].col, LCD_MOVE_LEFT);
+    CHECK_EQ(plan.ops[0].len, LCD_COLS);
+    CHECK_EQ(plan.cost, LCD_COLS * 4);
+
+    /* page 1 -> 0 at 100kHz: a home is cheaper than sixteen shifts */
+    plan_shift(&plan, LCD_COLS, 0, BYTE_NS_100K);
+    CHECK_EQ(plan.nops, 1);
+    CHECK_EQ(plan.ops[0].type, LCD_OP_HOME);
+    CHECK_EQ(plan.cost, CLEAR_100K);
+    CHECK_EQ(plan.ac, 0);
+
+    /* ... but not at 1MHz, where the 1.52ms wait dominates */
+    plan_shift(&plan, LCD_COLS, 0, BYTE_NS_1M);
+    CHECK_EQ(plan.nops, 1);
+    CHECK_EQ(plan.ops[0].type, LCD_OP_SHIFT);
+    CHECK_EQ(plan.ops[0].col, LCD_MOVE_RIGHT);
+    CHECK_EQ(plan.cost, LCD_COLS * 4);
+
+    /* going round the 40-column ring is shorter the other way */
+    plan_shift(&plan, 2, 36, BYTE_NS_1M);
+    CHECK_EQ(plan.ops[0].col, LCD_MOVE_RIGHT);
+    CHECK_EQ(plan.ops[0].len, 6);
+
+    /* an unknown shift needs a home first */
+    plan_shift(&plan, LCD_SHIFT_UNKNOWN, LCD_COLS, BYTE_NS_100K);
+    CHECK_EQ(plan.nops, 2);
+    CHECK_EQ(plan.ops[0].type, LCD_OP_HOME);
+    CHECK_EQ(plan.ops[1].type, LCD_OP_SHIFT);
+    CHECK_EQ(plan.cost, CLEAR_100K + LCD_COLS * 4);
+}
+
+/*
+reference for a single row: three-state DP over the columns
+A = nothing written yet, cursor still at ac
+B = cursor right at this column after a write
+C = cursor somewhere useless
+*/
+static unsigned int reference_row_cost(u64 need, int pos, unsigned int bc) {
+    const unsigned int inf = ~0u / 2;
+    unsigned int a = 0, b = inf, c = inf, na, nb, nc, col;
+    int n;
+
+    for (col = 0; col < LCD_DDRAM_COLS; col++) {
+        n = !!(need & BIT_ULL(col));
+        if ((int)col == pos && a < b)
+            b = a, a = inf;
+        na = n ? inf : a;
+        nb = b + bc;
+        if (a + 2 * bc < nb)
+            nb = a + 2 * bc;
+        if (c + 2 * bc < nb)
+            nb = c + 2 * bc;
+        nc = n ? inf : (c < b ? c : b);
+        a = na, b = nb, c = nc;
+    }
+    na = a < b ? a : b;
+    return na < c ? na : c;
+}
+
+static void test_random_rows_are_optimal(void) {
+    struct lcd_shadow sh;
+    unsigned int trial, col, want, clr;
+    u64 blank;
+    int ac;
+
+    srand(1602);
+    for (trial = 0; trial < 2000; trial++) {
+        memset(sh.ddram, ' ', sizeof(sh.ddram));
+        memset(sh.dirty, 0, sizeof(sh.dirty));
+        blank = 0;
+        for (col = 0; col < LCD_DDRAM_COLS; col++) {
+            if (rand() % 3 == 0)
+                sh.dirty[0] |= BIT_ULL(col);
+            if (rand() % 4 == 0)
+                sh.ddram[0][col] = 'a' + rand() % 26;
+            if (sh.ddram[0][col] != ' ')
+                blank |= BIT_ULL(col);
+        }
+        ac = rand() % 2 ? rand() % LCD_DDRAM_COLS : LCD_AC_UNKNOWN;
+
+        want = reference_row_cost(sh.dirty[0], ac, LCD_PORT_BYTES);
+        clr = CLEAR_100K + reference_row_cost(blank, 0, LCD_PORT_BYTES);
+        if (clr < want)
+            want = clr;
+        CHECK_EQ(plan_cost(&sh, ac, BYTE_NS_100K), want);
+    }
+}
+
+int main(void) {
+    test_cost_model();
+    test_corpus();
+    test_never_homes();
+    test_page_flips();
+    test_random_rows_are_optimal();
+    return check_report();
+}
@@ -0,0 +1,437 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * Unit tests for the PCF8574/HD44780 simulator, driven by the driver's
+ * own encoder and planner
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+extern "C" {
+#include "driver/lcd1602_encode.h"
+#include "driver/lcd1602_planner.h"
+#include "driver/lcd1602_exec.h"
+}
+#include "sim/hd44780_sim.h"
+#include "tests/check.h"
+
+namespace {
+
+const struct lcd_pinmap kDefaultMap = LCD_PINMAP_DEFAULT;
+
+/*
+ * A controller behind a backpack, fed through the driver's lcd_exec. Given
+ * a bus clock the run is timed, with the pad bytes and sleeps the driver
+ * would use at that clock.
+ */
+struct Rig {
+    lcdsim::Hd44780 lcd;
+    lcdsim::Pcf8574 pcf;
+    struct lcd_encoder enc;
+    struct lcd_timing timing;
+    struct lcd_exec x;
+
+    explicit Rig(u32 bus_hz = 0) : pcf(&lcd) {
+        static const struct lcd_exec_ops ops = { Xfer, SleepUs, nullptr };
+
+        lcd_encoder_init(&enc, &kDefaultMap, 1);
+        lcd_timing_init(&timing, bus_hz ? bus_hz : 100000);
+        lcd_exec_init(&x, &ops, this, &enc, &timing);
+        pcf.SetBusHz(bus_hz);
+    }
+    Rig(const Rig &) = delete;
+
+    static int Xfer(void *ctx, const u8 *buf, unsigned int len) {
+        static_cast<Rig *>(ctx)->pcf.Write(buf, len);
+        return 0;
+    }
+
+    static void SleepUs(void *ctx, unsigned int us) {
+        static_cast<Rig *>(ctx)->Sleep(us);
+    }
+
+    void Sleep(unsigned int us) {
+        pcf.Idle(us * 1000ULL);
+    }
+
+    void Send() {
+        lcd_exec_xfer(&x);
+    }
+
+    /* one reset nibble in a message of its own */
+    void Nibble(u8 nibble, unsigned int delay_us) {
+        lcd_stream_nibble(&x.stream, nibble, 0);
+        Send();
+        Sleep(delay_us);
+    }
+
+    /* send the stream first when it is full */
+    void Byte(u8 val, u8 rs) {
+        lcd_exec_emit(&x, val, rs);
+    }
+
+    void Text(const char *text) {
+        while (*text)
+            Byte(*text++, 1);
+    }
+
+    /* lcd_init_display(): datasheet reset, then the configuration */
+    void ColdInit() {
+        lcd_exec_reset(&x);
+        lcd_exec_configure(&x);
+    }
+
+    /* lcd_read_bf_ac(): the same five messages the driver sends */
+    u8 ReadBfAc() {
+        u8 port = enc.read_port;
+        u8 en_hi[2] = { port, static_cast<u8>(port | enc.en) };
+        u8 en_lo[1] = { port };
+        u8 hi, lo;
+
+        pcf.Write(en_hi, sizeof(en_hi));
+        pcf.Read(&hi, 1);
+        pcf.Write(en_hi, sizeof(en_hi));
+        pcf.Read(&lo, 1);
+        pcf.Write(en_lo, sizeof(en_lo));
+        return lcd_encoder_decode(&enc, hi) << 4 | lcd_encoder_decode(&enc, lo);
+    }
+};
+
+void TestColdInit() {
+    Rig r;
+
+    CHECK(!r.lcd.four_bit());
+    r.ColdInit();
+    CHECK(r.lcd.four_bit());
+    CHECK(r.lcd.two_line());
+    CHECK(r.lcd.display_on());
+    r.Text("Hello");
+    r.Send();
+    CHECK(r.lcd.Line(0) == "Hello           ");
+    CHECK(r.lcd.Line(1) == std::string(16, ' '));
+    CHECK(r.pcf.backlight());
+}
+
+void TestAddressing() {
+    Rig r;
+
+    r.ColdInit();
+    r.Byte(LCD_SET_DDRAM | (LCD_ROW_ADDR(1) + 3), 0);
+    r.Text("ab");
+    /* the end of line 0 runs on into line 1 */
+    r.Byte(LCD_SET_DDRAM | 0x27, 0);
+    r.Text("xy");
+    r.Send();
+    CHECK_EQ(r.lcd.ddram(0x27), 'x');
+    CHECK_EQ(r.lcd.Cell(1, 0), 'y');
+    CHECK_EQ(r.lcd.Cell(1, 3), 'a');
+    CHECK_EQ(r.lcd.address_counter(), 0x41);
+}
+
+void TestDisplayShift() {
+    Rig r;
+    int i;
+
+    r.ColdInit();
+    r.Byte(LCD_SET_DDRAM | LCD_COLS, 0);
+    r.Text("page1");
+    for (i = 0; i < LCD_COLS; i++)
+        r.Byte(LCD_CURSOR_SHIFT | LCD_DISPLAY_MOVE | LCD_MOVE_LEFT, 0);
+    r.Send();
+    CHECK_EQ(r.lcd.shift(), LCD_COLS);
+    CHECK(r.lcd.Line(0) == "page1           ");
+    r.Byte(LCD_HOME, 0);
+    r.Send();
+    CHECK_EQ(r.lcd.shift(), 0);
+}
+
+void TestCgram() {
+    Rig r;
+    int i;
+
+    r.ColdInit();
+    r.Byte(LCD_SET_CGRAM | 8, 0);
+    for (i = 0; i < 8; i++)
+        r.Byte(0x10 + i, 1);
+    r.Send();
+    CHECK_EQ(r.lcd.cgram()[8], 0x10);
+    CHECK_EQ(r.lcd.cgram()[15], 0x17);
+    CHECK(r.lcd.addressing_cgram());
+}
+
+void TestBusyFlagRead() {
+    Rig r;
+
+    r.ColdInit();
+    r.Byte(LCD_SET_DDRAM | 0x45, 0);
+    r.Send();
+    CHECK_EQ(r.ReadBfAc(), 0x45);
+    /* the read leaves the nibble phase alone */
+    r.Text("z");
+    r.Send();
+    CHECK_EQ(r.lcd.ddram(0x45), 'z');
+}
+
+/* the probe lcd_init_warm() makes, on a cold and on a configured controller */
+void TestWarmDetection() {
+    Rig cold, warm;
+
+    warm.ColdInit();
+    for (Rig *r : { &cold, &warm }) {
+        r->Byte(LCD_SET_DDRAM | 0x27, 0);
+        r->Byte(LCD_CURSOR_SHIFT | LCD_CURSOR_MOVE | LCD_MOVE_RIGHT, 0);
+        r->Send();
+    }
+    CHECK_EQ(warm.ReadBfAc(), LCD_ROW_ADDR(1));
+    CHECK(cold.ReadBfAc() != LCD_ROW_ADDR(1));
+}
+
+/* random frames flushed like lcd_flush(), checked on the glass */
+void TestPlannedFrames() {
+    Rig r;
+    struct lcd_frame f;
+    struct lcd_shadow *sh = &f.shadow;
+    unsigned int round, row, col, i;
+    u8 c;
+
+    r.ColdInit();
+    memset(&f, 0, sizeof(f));
+    memset(sh->ddram, ' ', sizeof(sh->ddram));
+    srand(1602);
+    for (round = 0; round < 200; round++) {
+        memset(sh->dirty, 0, sizeof(sh->dirty));
+        for (i = rand() % 12; i; i--) {
+            row = rand() % LCD_ROWS;
+            col = rand() % LCD_COLS;
+            c = 'a' + rand() % 26;
+            if (sh->ddram[row][col] != c) {
+                sh->ddram[row][col] = c;
+                sh->dirty[row] |= BIT_ULL(col);
+            }
+        }
+        CHECK_EQ(lcd_exec_flush(&r.x, &f, 0), 0);
+        CHECK_EQ(r.lcd.address_counter(), r.x.ac);
+        for (row = 0; row < LCD_ROWS; row++)
+            for (col = 0; col < LCD_COLS; col++)
+                CHECK_EQ(r.lcd.Cell(row, col), sh->ddram[row][col]);
+    }
+}
+
+/* glyphs go first, and a frame that does not fit is left to the solo path */
+void TestExecGlyphsAndBatch() {
+    Rig r;
+    struct lcd_frame f;
+    unsigned int i;
+
+    r.ColdInit();
+    memset(&f, 0, sizeof(f));
+    memset(f.shadow.ddram, ' ', sizeof(f.shadow.ddram));
+    f.uploads = 0x06;
+    for (i = 0; i < LCD_GLYPH_ROWS; i++) {
+        f.glyphs[1][i] = 0x10 + i;
+        f.glyphs[2][i] = 0x01;
+    }
+    f.shadow.ddram[0][0] = 1;
+    f.shadow.ddram[0][1] = 2;
+    f.shadow.dirty[0] = 0x3;
+    f.shift = 1;
+    CHECK_EQ(lcd_exec_flush(&r.x, &f, 1), 0);
+    CHECK(r.x.stream.len > 0);
+    Rig::Xfer(&r, r.x.stream.buf, r.x.stream.len);
+    lcd_exec_done(&r.x, 0);
+    CHECK_EQ(r.lcd.cgram()[LCD_GLYPH_ROWS + 7], 0x17);
+    CHECK_EQ(r.lcd.cgram()[2 * LCD_GLYPH_ROWS], 0x01);
+    CHECK_EQ(r.lcd.ddram(1), 2);
+    CHECK_EQ(r.lcd.shift(), 1);
+    CHECK_EQ(r.x.shift, 1);
+    CHECK_EQ(r.x.ac, 2);
+
+    /* a full page of new cells plus the way back does not fit */
+    f.uploads = 0;
+    for (i = 0; i < LCD_DDRAM_COLS; i++)
+        f.shadow.ddram[0][i] = f.shadow.ddram[1][i] = 'a' + i % 26;
+    f.shadow.dirty[0] = f.shadow.dirty[1] = BIT_ULL(LCD_DDRAM_COLS) - 1;
+    f.shift = 0;
+    CHECK_EQ(lcd_exec_flush(&r.x, &f, 1), -EAGAIN);
+    CHECK_EQ(r.x.stream.len, 0);
+    CHECK_EQ(r.x.ac, 2);
+    CHECK_EQ(lcd_exec_flush(&r.x, &f, 0), 0);
+    CHECK(r.lcd.Line(1) == "abcdefghijklmnop");
+}
+
+void TestStats() {
+    Rig r;
+
+    r.ColdInit();
+    r.pcf.ResetStats();
+    r.Text("0123456789");
+    r.Send();
+    CHECK_EQ(r.pcf.stats().messages, 1);
+    CHECK_EQ(r.pcf.stats().port_writes, 1 + 10 * LCD_PORT_BYTES);
+    CHECK_EQ(r.pcf.stats().en_edges, 20);
+    CHECK_EQ(r.pcf.stats().wire_bytes(), 2 + 10 * LCD_PORT_BYTES);
+}
+
+/* the driver's pad bytes and sleeps keep every bus clock within spec */
+void TestTimedInit() {
+    const char *rows[LCD_ROWS] = { "0123456789abcdef", "fedcba9876543210" };
+    u32 clocks[] = { 100000, 400000, 1000000 };
+    unsigned int row;
+
+    for (u32 hz : clocks) {
+        Rig r(hz);
+
+        r.ColdInit();
+        for (row = 0; row < LCD_ROWS; row++) {
+            r.Byte(LCD_SET_DDRAM | LCD_ROW_ADDR(row), 0);
+            r.Text(rows[row]);
+        }
+        r.Send();
+        r.Byte(LCD_HOME, 0);
+        r.Send();
+        r.Sleep(r.timing.slow_cmd_us);
+        r.Text("X");
+        r.Send();
+        CHECK_EQ(r.lcd.violations().size(), 0);
+        CHECK(r.lcd.Line(0) == "X123456789abcdef");
+        CHECK(r.lcd.Line(1) == rows[1]);
+    }
+}
+
+/* without pad bytes 1MHz is too fast for a 37us instruction */
+void TestTimedTooFast() {
+    Rig r(1000000);
+
+    lcd_stream_init(&r.x.stream, &r.enc, 0);
+    r.ColdInit();
+    CHECK(!r.lcd.violations().empty());
+    for (const lcdsim::Violation &v : r.lcd.violations()) {
+        CHECK_EQ(v.kind, lcdsim::Violation::kBusy);
+        CHECK(v.short_ns > 0 && v.short_ns < 37000);
+    }
+}
+
+/* skipping the power-on or reset-sequence waits is caught */
+void TestTimedInitWaits() {
+    Rig r(100000);
+
+    lcd_stream_power_on(&r.x.stream);
+    r.Nibble(0x03, 0);
+    CHECK_EQ(r.lcd.violations().size(), 1);
+    CHECK_EQ(r.lcd.violations()[0].kind, lcdsim::Violation::kBusy);
+    CHECK(r.lcd.violations()[0].short_ns > 39000000);
+
+    r.lcd.ClearViolations();
+    r.Nibble(0x03, 0);
+    CHECK_EQ(r.lcd.violations().size(), 1);
+    CHECK(r.lcd.violations()[0].short_ns > 3700000);
+}
+
+/* edges the bus cannot produce, given with explicit timestamps */
+void TestTimedEdges() {
+    lcdsim::Hd44780 lcd;
+    lcdsim::Pcf8574 pcf(&lcd);
+    const uint64_t t0 = 50000000;
+    u8 d = 0xA8;                                /* D7-D4 = 0xA, backlight */
+
+    pcf.SetBusHz(100000);
+    pcf.WritePort(d, t0 - 1000000);             /* EN is high at power-on */
+    lcd.ClearViolations();
+    pcf.WritePort(d | 0x04, t0);
+    pcf.WritePort(d, t0 + 200);                 /* pulse 200ns */
+    CHECK_EQ(lcd.violations().size(), 1);
+    CHECK_EQ(lcd.violations()[0].kind, lcdsim::Violation::kPulseWidth);
+    CHECK_EQ(lcd.violations()[0].short_ns, 250);
+
+    lcd.ClearViolations();
+    pcf.WritePort(0x04, t0 + 5000000);
+    pcf.WritePort(d, t0 + 5000500);             /* data changes as EN falls */
+    CHECK_EQ(lcd.violations().size(), 1);
+    CHECK_EQ(lcd.violations()[0].kind, lcdsim::Violation::kSetup);
+
+    lcd.ClearViolations();
+    pcf.WritePort(d | 0x04, t0 + 5000600);
+    pcf.WritePort(d, t0 + 5001200);             /* 700ns after the last fall */
+    CHECK_EQ(lcd.violations().size(), 2);
+    CHECK_EQ(lcd.violations()[0].kind, lcdsim::Violation::kCycleTime);
+    CHECK_EQ(lcd.violations()[1].kind, lcdsim::Violation::kBusy);
+}
+
+/* RS/RW need tAS before EN rises and every line tAH/tH after it falls */
+void TestTimedAddressEdges() {
+    lcdsim::Hd44780 lcd;
+    lcdsim::Pcf8574 pcf(&lcd);
+    const uint64_t t0 = 50000000;
+    u8 d = 0xA8;                                /* D7-D4 = 0xA, backlight */
+
+    pcf.SetBusHz(100000);
+    pcf.WritePort(d, t0 - 1000000);
+    lcd.ClearViolations();
+    pcf.WritePort(d | 0x01, t0);                /* RS up, 40ns to the rise */
+    pcf.WritePort(d | 0x05, t0 + 40);
+    CHECK_EQ(lcd.violations().size(), 1);
+    CHECK_EQ(lcd.violations()[0].kind, lcdsim::Violation::kAddressSetup);
+    CHECK_EQ(lcd.violations()[0].short_ns, 20);
+
+    lcd.ClearViolations();
+    pcf.WritePort(d | 0x04, t0 + 500);          /* RS drops during the pulse */
+    pcf.WritePort(d, t0 + 1000);
+    CHECK_EQ(lcd.violations().size(), 1);
+    CHECK_EQ(lcd.violations()[0].kind, lcdsim::Violation::kAddressSetup);
+
+    lcd.ClearViolations();
+    pcf.WritePort(0x58, t0 + 1010);             /* data 10ns after the fall */
+    CHECK_EQ(lcd.violations().size(), 1);
+    CHECK_EQ(lcd.violations()[0].kind, lcdsim::Violation::kHold);
+    CHECK_EQ(lcd.violations()[0].short_ns, 10);
+}
+
+/* a byte whose EN-high port byte also switches RS is caught on the bus */
+void TestTimedNoSetupByte() {
+    Rig r(100000);
+    const u8 *seq = r.enc.byte[1]['x'];
+
+    r.ColdInit();
+    r.lcd.ClearViolations();
+    r.Sleep(100);
+    r.pcf.Write(seq, LCD_PORT_BYTES);
+    CHECK_EQ(r.lcd.violations().size(), 1);
+    CHECK_EQ(r.lcd.violations()[0].kind, lcdsim::Violation::kAddressSetup);
+    CHECK_EQ(r.lcd.violations()[0].short_ns, 60);
+}
+
+/* BF reads busy until the clear has executed */
+void TestTimedBusyFlag() {
+    Rig r(400000);
+
+    r.ColdInit();
+    r.Byte(LCD_CLEAR, 0);
+    r.Send();
+    CHECK(r.ReadBfAc() & 0x80);
+    r.Sleep(r.timing.slow_cmd_us);
+    CHECK_EQ(r.ReadBfAc(), 0x00);
+    CHECK_EQ(r.lcd.violations().size(), 0);
+}
+
+}  // namespace
+
+int main() {
+    TestColdInit();
+    TestAddressing();
+    TestDisplayShift();
+    TestCgram();
+    TestBusyFlagRead();
+    TestWarmDetection();
+    TestPlannedFrames();
+    TestExecGlyphsAndBatch();
+    TestStats();
+    TestTimedInit();
+    TestTimedTooFast();
+    TestTimedInitWaits();
+    TestTimedEdges();
+    TestTimedAddressEdges();
+    TestTimedNoSetupByte();
+    TestTimedBusyFlag();
+    return check_report();
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * Unit tests for the DDRAM widgets
+ */
+
+#include <string.h>
+#include "driver/lcd1602_widget.h"
+#include "driver/lcd1602_glyph.h"
+#include "tests/check.h"
+
+#define PARTIAL 0x03
+
+static void test_bar_steps(void) {
+    CHECK_EQ(lcd_bar_steps(0, 100, LCD_COLS), 0);
+    CHECK_EQ(lcd_bar_steps(50, 100, LCD_COLS), 40);
+    CHECK_EQ(lcd_bar_steps(100, 100, LCD_COLS), 80);
+    CHECK_EQ(lcd_bar_steps(250, 100, LCD_COLS), 80);
+    CHECK_EQ(lcd_bar_steps(0x80000000U, 0xFFFFFFFFU, LCD_COLS), 40);
+    CHECK_EQ(lcd_bar_steps(0xFFFFFFFEU, 0xFFFFFFFFU, LCD_COLS), 79);
+}
+
+static void test_bar_glyph(void) {
+    u8 bm[LCD_GLYPH_ROWS];
+    unsigned int i;
+
+    lcd_bar_glyph(bm, 1);
+    for (i = 0; i < LCD_GLYPH_ROWS; i++)
+        CHECK_EQ(bm[i], 0x10);
+    lcd_bar_glyph(bm, 4);
+    CHECK_EQ(bm[0], 0x1E);
+}
+
+static void test_bar_cells(void) {
+    u8 cells[LCD_COLS];
+
+    lcd_bar_cells(cells, 4, 7, PARTIAL);
+    CHECK_EQ(cells[0], LCD_BAR_FULL);
+    CHECK_EQ(cells[1], PARTIAL);
+    CHECK_EQ(cells[2], LCD_BAR_EMPTY);
+    CHECK_EQ(cells[3], LCD_BAR_EMPTY);
+
+    /* a whole number of cells has no partial cell */
+    lcd_bar_cells(cells, 4, 10, PARTIAL);
+    CHECK(memchr(cells, PARTIAL, 4) == NULL);
+    CHECK_EQ(cells[1], LCD_BAR_FULL);
+    CHECK_EQ(cells[2], LCD_BAR_EMPTY);
+}
+
+/* one step more changes at most the cell at the end of the bar and the next */
+static void test_bar_step_touches_two_cells(void) {
+    u8 a[LCD_COLS], b[LCD_COLS];
+    unsigned int steps, i, changed;
+
+    for (steps = 0; steps < LCD_COLS * LCD_BAR_STEPS_PER_CELL; steps++) {
+        lcd_bar_cells(a, LCD_COLS, steps, PARTIAL);
+        lcd_bar_cells(b, LCD_COLS, steps + 1, PARTIAL);
+        changed = 0;
+        for (i = 0; i < LCD_COLS; i++)
+            changed += a[i] != b[i];
+        CHECK(changed <= 2);
+    }
+}
+
+/* with every other slot on the glass, a bar keeps using its own slot */
+static void test_bar_reuses_own_slot(void) {
+    u8 ddram[LCD_ROWS][LCD_DDRAM_COLS], cells[LCD_COLS], bitmap[LCD_GLYPH_ROWS];
+    struct lcd_glyph_cache gc;
+    unsigned int i;
+    int code;
+
+    lcd_glyph_cache_init(&gc);
+    memset(ddram, ' ', sizeof(ddram));
+    for (i = 0; i < LCD_CGRAM_SLOTS - 1; i++) {
+        memset(bitmap, 0, sizeof(bitmap));
+        bitmap[0] = i + 1;
+        ddram[1][20 + i] = lcd_glyph_get(&gc, bitmap, 0);
+    }
+
+    code = lcd_bar_render(cells, &gc, &ddram[0][0], 0, 0, 8, 11, 40);
+    CHECK(code >= 0 && code < LCD_CGRAM_SLOTS);
+    CHECK_EQ(cells[2], code);
+    memcpy(ddram[0], cells, 8);
+
+    /* 3 of 5 columns lit in the next cell, a different glyph */
+    CHECK_EQ(lcd_bar_render(cells, &gc, &ddram[0][0], 0, 0, 8, 18, 40), code);
+    CHECK_EQ(cells[2], LCD_BAR_FULL);
+    CHECK_EQ(cells[3], code);
+
+    /* a second bar elsewhere finds no free slot */
+    CHECK_EQ(lcd_bar_render(cells, &gc, &ddram[0][0], 1, 0, 8, 11, 40),
+             -ENOSPC);
+}
+
+static const u8 big_codes[LCD_BIG_GLYPHS] = { 0x05, 0x06, 0x07 };
+
+static void test_big_glyphs(void) {
+    u8 bm[LCD_GLYPH_ROWS];
+
+    lcd_big_glyph(bm, LCD_BIG_TOP);
+    CHECK_EQ(bm[0], 0x1F);
+    CHECK_EQ(bm[2], 0x1F);
+    CHECK_EQ(bm[3], 0x00);
+    CHECK_EQ(bm[7], 0x00);
+    lcd_big_glyph(bm, LCD_BIG_BOTH);
+    CHECK_EQ(bm[1], 0x1F);
+    CHECK_EQ(bm[4], 0x00);
+    CHECK_EQ(bm[6], 0x1F);
+}
+
+static void test_big_layout(void) {
+    u8 cells[LCD_ROWS][LCD_COLS];
+
+    CHECK_EQ(lcd_big_render(cells, LCD_COLS, "12:34", 5, big_codes), 15);
+    /* "1": top bar, block, blank over bottom bar, block, bottom bar */
+    CHECK_EQ(cells[0][0], 0x05);
+    CHECK_EQ(cells[0][1], LCD_BAR_FULL);
+    CHECK_EQ(cells[1][2], 0x06);
+    /* blank column between digits, none around the colon */
+    CHECK_EQ(cells[0][3], ' ');
+    CHECK_EQ(cells[0][7], 0xA5);
+    CHECK_EQ(cells[1][7], 0xA5);
+    CHECK_EQ(cells[1][15], ' ');
+
+    CHECK_EQ(lcd_big_render(cells, LCD_COLS, "12345", 5, big_codes), -ENOSPC);
+    CHECK_EQ(lcd_big_render(cells, LCD_COLS, "1a", 2, big_codes), -EINVAL);
+}
+
+/* a clock tick only changes the cells of the digit that changed */
+static void test_big_tick_touches_one_digit(void) {
+    u8 a[LCD_ROWS][LCD_COLS], b[LCD_ROWS][LCD_COLS];
+    unsigned int row, col;
+
+    lcd_big_render(a, LCD_COLS, "12:34", 5, big_codes);
+    lcd_big_render(b, LCD_COLS, "12:35", 5, big_codes);
+    for (row = 0; row < LCD_ROWS; row++)
+        for (col = 0; col < 12; col++)
+            CHECK_EQ(a[row][col], b[row][col]);
+    CHECK(memcmp(a[0] + 12, b[0] + 12, 3) || memcmp(a[1] + 12, b[1] + 12, 3));
+}
+
+int main(void) {
+    test_bar_steps();
+    test_bar_glyph();
+    test_bar_cells();
+    test_bar_step_touches_two_cells();
+    test_bar_reuses_own_slot();
+    test_big_glyphs();
+    test_big_layout();
+    test_big_tick_touches_one_digit();
+    return check_report();
+}
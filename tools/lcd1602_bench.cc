@@ -0,0 +1,509 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * lcd1602_bench - bus cost and latency of standard lcd1602 workloads
+ *
+ * usage: lcd1602_bench [-j] [-n events] [-o file]
+ *
+ * Each workload writes into a shadow the way write() and the ioctls do,
+ * and flushes it through the same lcd_exec as lcd_flush(): glyph uploads,
+ * the planner, the encoder and the timing plan of the bus clock. Frames that arrive while
+ * the bus is busy are coalesced into the next flush, like the bus
+ * scheduler does. The port bytes go to the timed PCF8574/HD44780
+ * simulator, which gives the wire time and checks every EN edge against
+ * the datasheet.
+ *
+ * Per workload and bus clock (100kHz and 400kHz) it reports the bytes on
+ * the wire, the I2C messages, the simulated wire and sleep time, the CPU
+ * time spent planning and encoding, and the latency from write() to glass
+ * in simulated time. -j prints JSON for regression gating, -n caps the
+ * events per workload, -o writes to a file. A timing violation, or a
+ * screen that ends up different from the frame, fails the run.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+#include <unistd.h>
+
+extern "C" {
+#include "driver/lcd1602_encode.h"
+#include "driver/lcd1602_planner.h"
+#include "driver/lcd1602_glyph.h"
+#include "driver/lcd1602_widget.h"
+#include "driver/lcd1602_exec.h"
+}
+#include "sim/hd44780_sim.h"
+
+namespace {
+
+const struct lcd_pinmap kDefaultMap = LCD_PINMAP_DEFAULT;
+const u32 kBusClocks[] = { 100000, 400000 };
+
+uint64_t CpuNs() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* one panel: the driver's per-device state in front of the simulator */
+class Panel {
+ public:
+    explicit Panel(u32 bus_hz);
+
+    /* lcd_init_display(), cold and with fixed delays */
+    void ColdInit();
+
+    /* lcd1602_write() into a page */
+    void Write(unsigned int page, const char *text);
+
+    /* lcd_bar_draw() */
+    void Bar(unsigned int row, unsigned int col, unsigned int width,
+             u32 value, u32 max);
+
+    /* LCD1602_IOC_SHOW_PAGE */
+    void ShowPage(unsigned int page) { want_shift_ = page * LCD_COLS; }
+
+    bool Dirty() const;
+
+    /* lcd_frame_begin() and lcd_flush(), then put the bytes on the bus */
+    void Flush();
+
+    /* the glass shows the frame, CGRAM included */
+    bool GlassMatches() const;
+
+    void IdleUntil(uint64_t t_ns) {
+        if (t_ns > pcf_.now_ns())
+            pcf_.Idle(t_ns - pcf_.now_ns());
+    }
+    void ResetCounters();
+
+    uint64_t now_ns() const { return pcf_.now_ns(); }
+    uint64_t glass_ns() const { return glass_ns_; }
+    const lcdsim::Pcf8574::Stats &stats() const { return pcf_.stats(); }
+    size_t violations() const { return lcd_.violations().size(); }
+    unsigned long frames() const { return frames_; }
+    uint64_t cpu_ns() const { return cpu_ns_; }
+    uint64_t sleep_ns() const { return sleep_ns_; }
+    uint64_t wire_ns() const {
+        return stats().wire_bytes() * 9000000000ULL / timing_.bus_hz;
+    }
+
+ private:
+    /* a message to send, then a sleep */
+    struct Step {
+        std::vector<u8> msg;
+        unsigned int sleep_us;
+    };
+
+    /* lcd_exec_ops, ctx is the Panel */
+    static int Xfer(void *ctx, const u8 *buf, unsigned int len);
+    static void Sleep(void *ctx, unsigned int us);
+
+    void Put(unsigned int row, unsigned int col, u8 c);
+    void Replay();
+
+    lcdsim::Hd44780 lcd_;
+    lcdsim::Pcf8574 pcf_;
+    struct lcd_encoder enc_;
+    struct lcd_timing timing_;
+    struct lcd_exec exec_;
+    struct lcd_glyph_cache glyphs_;
+    struct lcd_shadow shadow_;
+    struct lcd_frame frame_;
+    int want_shift_;
+    std::vector<Step> steps_;
+    uint64_t glass_ns_;
+    unsigned long frames_;
+    uint64_t cpu_ns_;
+    uint64_t sleep_ns_;
+};
+
+Panel::Panel(u32 bus_hz)
+    : pcf_(&lcd_), want_shift_(0), glass_ns_(0), frames_(0), cpu_ns_(0),
+      sleep_ns_(0) {
+    static const struct lcd_exec_ops ops = { Xfer, Sleep, nullptr };
+
+    lcd_encoder_init(&enc_, &kDefaultMap, 1);
+    lcd_timing_init(&timing_, bus_hz);
+    lcd_exec_init(&exec_, &ops, this, &enc_, &timing_);
+    lcd_glyph_cache_init(&glyphs_);
+    memset(&shadow_, 0, sizeof(shadow_));
+    memset(shadow_.ddram, ' ', sizeof(shadow_.ddram));
+    pcf_.SetBusHz(bus_hz);
+}
+
+void Panel::ColdInit() {
+    lcd_exec_reset(&exec_);
+    lcd_exec_configure(&exec_);
+    Replay();
+}
+
+void Panel::Put(unsigned int row, unsigned int col, u8 c) {
+    if (shadow_.ddram[row][col] == c)
+        return;
+    shadow_.ddram[row][col] = c;
+    shadow_.dirty[row] |= BIT_ULL(col);
+}
+
+void Panel::Write(unsigned int page, const char *text) {
+    unsigned int row = 0, col = 0;
+
+    for (; *text; text++) {
+        if (*text == '\n') {
+            if (++row >= LCD_ROWS)
+                break;
+            col = 0;
+            continue;
+        }
+        if (col < LCD_COLS)
+            Put(row, page * LCD_COLS + col++, *text);
+    }
+}
+
+void Panel::Bar(unsigned int row, unsigned int col, unsigned int width,
+                u32 value, u32 max) {
+    u8 cells[LCD_COLS];
+    unsigned int i;
+
+    if (lcd_bar_render(cells, &glyphs_, &shadow_.ddram[0][0], row, col, width,
+                       value, max) < 0)
+        return;
+    for (i = 0; i < width; i++)
+        Put(row, col + i, cells[i]);
+}
+
+bool Panel::Dirty() const {
+    return shadow_.dirty[0] || shadow_.dirty[1] || glyphs_.upload ||
+           exec_.shift != want_shift_;
+}
+
+int Panel::Xfer(void *ctx, const u8 *buf, unsigned int len) {
+    Panel *p = static_cast<Panel *>(ctx);
+    Step step;
+
+    step.msg.assign(buf, buf + len);
+    step.sleep_us = 0;
+    p->steps_.push_back(step);
+    return 0;
+}
+
+void Panel::Sleep(void *ctx, unsigned int us) {
+    Step step;
+
+    step.sleep_us = us;
+    static_cast<Panel *>(ctx)->steps_.push_back(step);
+}
+
+void Panel::Flush() {
+    uint64_t start = CpuNs();
+    unsigned int slot;
+
+    frame_.shadow = shadow_;
+    shadow_.dirty[0] = shadow_.dirty[1] = 0;
+    frame_.shift = want_shift_;
+    frame_.uploads = glyphs_.upload;
+    glyphs_.upload = 0;
+    for (slot = 0; slot < LCD_CGRAM_SLOTS; slot++)
+        if (frame_.uploads & (1U << slot))
+            memcpy(frame_.glyphs[slot], glyphs_.slots[slot].bitmap,
+                   LCD_GLYPH_ROWS);
+    lcd_exec_flush(&exec_, &frame_, 0);
+    cpu_ns_ += CpuNs() - start;
+    frames_++;
+    Replay();
+}
+
+/* the frame is on the glass once its last port byte is */
+void Panel::Replay() {
+    for (const Step &step : steps_) {
+        if (!step.msg.empty()) {
+            pcf_.Write(step.msg.data(), step.msg.size());
+            glass_ns_ = pcf_.now_ns();
+        }
+        pcf_.Idle(step.sleep_us * 1000ULL);
+        sleep_ns_ += step.sleep_us * 1000ULL;
+    }
+    steps_.clear();
+}
+
+bool Panel::GlassMatches() const {
+    unsigned int row, col, i;
+    u8 c;
+
+    for (row = 0; row < LCD_ROWS; row++) {
+        for (col = 0; col < LCD_COLS; col++) {
+            c = shadow_.ddram[row][(col + want_shift_) % LCD_DDRAM_COLS];
+            if (lcd_.Cell(row, col) != c)
+                return false;
+            if (c >= 2 * LCD_CGRAM_SLOTS)
+                continue;
+            for (i = 0; i < LCD_GLYPH_ROWS; i++)
+                if (lcd_.cgram()[(c % LCD_CGRAM_SLOTS) * LCD_GLYPH_ROWS + i] !=
+                    glyphs_.slots[c % LCD_CGRAM_SLOTS].bitmap[i])
+                    return false;
+        }
+    }
+    return true;
+}
+
+void Panel::ResetCounters() {
+    pcf_.ResetStats();
+    frames_ = 0;
+    cpu_ns_ = 0;
+    sleep_ns_ = 0;
+}
+
+/* events arrive every period_ns, setup runs before the clock starts */
+struct Workload {
+    const char *name;
+    unsigned int events;
+    uint64_t period_ns;
+    void (*setup)(Panel *p);
+    void (*event)(Panel *p, unsigned int i);
+};
+
+/* every cell changes, 20 frames/s */
+void FullRefreshEvent(Panel *p, unsigned int i) {
+    char text[2 * (LCD_COLS + 1)];
+    unsigned int row, col;
+
+    for (row = 0; row < LCD_ROWS; row++) {
+        for (col = 0; col < LCD_COLS; col++)
+            text[row * (LCD_COLS + 1) + col] = 'A' + (i + row + col) % 26;
+        text[row * (LCD_COLS + 1) + LCD_COLS] = '\n';
+    }
+    text[sizeof(text) - 1] = '\0';
+    p->Write(0, text);
+}
+
+void ClockSetup(Panel *p) {
+    p->Write(0, "\n   2026-10-16");
+}
+
+/* hh:mm:ss once a second, usually only the last digit changes */
+void ClockEvent(Panel *p, unsigned int i) {
+    unsigned int t = 12 * 3600 + 34 * 60 + 56 + i;
+    char text[LCD_COLS + 1];
+
+    snprintf(text, sizeof(text), "    %02u:%02u:%02u    ", t / 3600 % 24,
+             t / 60 % 60, t % 60);
+    p->Write(0, text);
+}
+
+void LogLine(char *line, unsigned int n) {
+    static const char *const msgs[] = {
+        "link up", "dhcp ok", "ntp sync", "temp 41C", "disk 73%",
+        "fan 2100rpm", "login root", "cron run",
+    };
+
+    snprintf(line, LCD_COLS + 1, "%04u %-11s", n, msgs[n * 5 % 8]);
+}
+
+/* a new line at the bottom, the previous one moves up, 10 lines/s */
+void LogTailEvent(Panel *p, unsigned int i) {
+    char prev[LCD_COLS + 1], cur[LCD_COLS + 1], text[2 * (LCD_COLS + 1)];
+
+    LogLine(prev, i);
+    LogLine(cur, i + 1);
+    snprintf(text, sizeof(text), "%s\n%s", prev, cur);
+    p->Write(0, text);
+}
+
+/* two bars following a random walk, 20 updates/s */
+void BarEvent(Panel *p, unsigned int i) {
+    static u32 value[LCD_ROWS] = { 500, 250 };
+    unsigned int row;
+
+    if (!i) {
+        value[0] = 500;
+        value[1] = 250;
+    }
+    for (row = 0; row < LCD_ROWS; row++) {
+        /* deterministic walk of up to +-30 out of 1000 */
+        value[row] += (i * 7919 + row * 104729) % 61;
+        value[row] = value[row] > 30 ? value[row] - 30 : 0;
+        value[row] = std::min<u32>(value[row], 1000);
+        p->Bar(row, 0, LCD_COLS, value[row], 1000);
+    }
+}
+
+void PagesSetup(Panel *p) {
+    p->Write(0, "eth0 10.0.0.17\nup 3d 04:12");
+    p->Write(1, "cpu 12% mem 41%\nload 0.42 0.37");
+}
+
+/* flip between two pages drawn once, every 2s */
+void PagesEvent(Panel *p, unsigned int i) {
+    p->ShowPage((i + 1) % 2);
+}
+
+const Workload kWorkloads[] = {
+    { "full_refresh", 200, 50000000ULL, NULL, FullRefreshEvent },
+    { "clock_1hz", 600, 1000000000ULL, ClockSetup, ClockEvent },
+    { "log_tail", 300, 100000000ULL, NULL, LogTailEvent },
+    { "bar_telemetry", 400, 50000000ULL, NULL, BarEvent },
+    { "page_rotation", 100, 2000000000ULL, PagesSetup, PagesEvent },
+};
+
+struct Result {
+    const Workload *w;
+    u32 bus_hz;
+    unsigned int events;
+    unsigned long frames;
+    unsigned long wire_bytes;
+    unsigned long transactions;
+    double wire_ms;
+    double sleep_ms;
+    double cpu_us_per_frame;
+    double latency_us[4];   /* p50, p90, p99, max */
+    size_t violations;
+    bool glass_ok;
+};
+
+const double kPercentiles[] = { 50, 90, 99, 100 };
+
+Result Run(const Workload &w, u32 bus_hz, unsigned int max_events) {
+    Panel p(bus_hz);
+    std::vector<uint64_t> latency;
+    unsigned int n = std::min(w.events, max_events);
+    unsigned int i = 0, first, k;
+    uint64_t t0;
+    Result r = Result();
+
+    p.ColdInit();
+    if (w.setup) {
+        w.setup(&p);
+        p.Flush();
+    }
+    p.ResetCounters();
+    t0 = p.now_ns();
+    while (i < n) {
+        p.IdleUntil(t0 + i * w.period_ns);
+        /* everything written while the bus was busy goes in one frame */
+        first = i;
+        while (i < n && t0 + i * w.period_ns <= p.now_ns())
+            w.event(&p, i++);
+        if (p.Dirty())
+            p.Flush();
+        for (k = first; k < i; k++)
+            latency.push_back(std::max(p.glass_ns(), t0 + k * w.period_ns) -
+                              (t0 + k * w.period_ns));
+    }
+    std::sort(latency.begin(), latency.end());
+
+    r.w = &w;
+    r.bus_hz = bus_hz;
+    r.events = n;
+    r.frames = p.frames();
+    r.wire_bytes = p.stats().wire_bytes();
+    r.transactions = p.stats().messages;
+    r.wire_ms = p.wire_ns() / 1e6;
+    r.sleep_ms = p.sleep_ns() / 1e6;
+    r.cpu_us_per_frame = p.frames() ? p.cpu_ns() / 1e3 / p.frames() : 0;
+    for (k = 0; k < 4 && !latency.empty(); k++) {
+        /* nearest rank */
+        size_t rank = std::ceil(kPercentiles[k] / 100 * latency.size());
+
+        r.latency_us[k] = latency[std::max<size_t>(rank, 1) - 1] / 1e3;
+    }
+    r.violations = p.violations();
+    r.glass_ok = p.GlassMatches();
+    return r;
+}
+
+void PrintTable(FILE *out, const std::vector<Result> &results) {
+    fprintf(out, "%-14s %7s %6s %6s %10s %6s %9s %9s %9s %9s %9s %9s\n",
+            "workload", "bus_hz", "events", "frames", "wire_bytes", "msgs",
+            "wire_ms", "sleep_ms", "cpu_us/fr", "p50_us", "p99_us", "max_us");
+    for (const Result &r : results)
+        fprintf(out, "%-14s %7u %6u %6lu %10lu %6lu %9.1f %9.1f %9.2f "
+                "%9.0f %9.0f %9.0f\n",
+                r.w->name, r.bus_hz, r.events, r.frames, r.wire_bytes,
+                r.transactions, r.wire_ms, r.sleep_ms, r.cpu_us_per_frame,
+                r.latency_us[0], r.latency_us[2], r.latency_us[3]);
+}
+
+void PrintJson(FILE *out, const std::vector<Result> &results) {
+    size_t i;
+
+    fprintf(out, "{\n  \"results\": [\n");
+    for (i = 0; i < results.size(); i++) {
+        const Result &r = results[i];
+
+        fprintf(out, "    {\"workload\": \"%s\", \"bus_hz\": %u, "
+                "\"events\": %u, \"frames\": %lu, \"wire_bytes\": %lu, "
+                "\"transactions\": %lu, \"wire_time_ms\": %.3f, "
+                "\"sleep_time_ms\": %.3f, \"cpu_us_per_frame\": %.3f, "
+                "\"latency_us\": {\"p50\": %.1f, \"p90\": %.1f, "
+                "\"p99\": %.1f, \"max\": %.1f}, "
+                "\"timing_violations\": %zu, \"glass_ok\": %s}%s\n",
+                r.w->name, r.bus_hz, r.events, r.frames, r.wire_bytes,
+                r.transactions, r.wire_ms, r.sleep_ms, r.cpu_us_per_frame,
+                r.latency_us[0], r.latency_us[1], r.latency_us[2],
+                r.latency_us[3], r.violations, r.glass_ok ? "true" : "false",
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    std::vector<Result> results;
+    unsigned int max_events = ~0U;
+    const char *path = NULL;
+    bool json = false;
+    FILE *out = stdout;
+    int opt, failed = 0;
+
+    while ((opt = getopt(argc, argv, "jn:o:")) != -1) {
+        switch (opt) {
+        case 'j':
+            json = true;
+            break;
+        case 'n':
+            max_events = strtoul(optarg, NULL, 0);
+            break;
+        case 'o':
+            path = optarg;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-j] [-n events] [-o file]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    for (const Workload &w : kWorkloads) {
+        for (u32 hz : kBusClocks) {
+            results.push_back(Run(w, hz, max_events));
+            const Result &r = results.back();
+            if (r.violations || !r.glass_ok) {
+                fprintf(stderr, "%s at %uHz: %zu timing violation(s)%s\n",
+                        w.name, hz, r.violations,
+                        r.glass_ok ? "" : ", glass differs from the frame");
+                failed = 1;
+            }
+        }
+    }
+
+    if (path) {
+        out = fopen(path, "w");
+        if (!out) {
+            perror(path);
+            return 1;
+        }
+    }
+    if (json)
+        PrintJson(out, results);
+    else
+        PrintTable(out, results);
+    if (out != stdout)
+        fclose(out);
+    return failed;
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2026 <Nikolay Chalkanov, aka PilotChalkanov>
+ * lcd1602_scale - aggregate frame rate of lcd1602 panels versus adapters
+ *
+ * usage: lcd1602_scale [-s seconds] /dev/lcd1602-<bus>-<addr>...
+ *
+ * The nodes are grouped by the adapter in their name. For k = 1..adapters,
+ * every panel on the first k adapters is driven by a thread of its own
+ * that writes a full frame in which every cell changes, then fsync()s
+ * until the frame is on the glass. The total frames/sec of each step
+ * shows how well flushing scales across buses: with a kthread per adapter
+ * (optionally pinned with bus_cpu=) it should grow about linearly with k,
+ * while panels on the same adapter share its bandwidth.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_PANELS  64
+#define FRAME_LEN   (2 * 17)
+
+struct panel {
+    const char *path;
+    int bus;
+    int fd;
+    pthread_t thread;
+    unsigned long frames;
+    int err;
+};
+
+static volatile int running;
+
+static double now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* full frame where every cell differs from the previous one */
+static void *panel_run(void *arg) {
+    struct panel *p = arg;
+    char frame[FRAME_LEN];
+    unsigned long n = 0;
+    int i;
+
+    while (running) {
+        for (i = 0; i < FRAME_LEN; i++)
+            frame[i] = 'A' + (n + i) % 26;
+        frame[16] = '\n';
+        frame[FRAME_LEN - 1] = '\n';
+        if (write(p->fd, frame, sizeof(frame)) < 0 || fsync(p->fd) < 0) {
+            p->err = errno;
+            break;
+        }
+        n++;
+    }
+    p->frames = n;
+    return NULL;
+}
+
+/* adapter number from /dev/lcd1602-<bus>-<addr> */
+static int panel_bus(const char *path) {
+    const char *name = strrchr(path, '/');
+    int bus;
+    unsigned int addr;
+
+    name = name ? name + 1 : path;
+    if (sscanf(name, "lcd1602-%d-%x", &bus, &addr) != 2)
+        return -1;
+    return bus;
+}
+
+static int cmp_int(const void *a, const void *b) {
+    return *(const int *)a - *(const int *)b;
+}
+
+int main(int argc, char **argv) {
+    struct panel panels[MAX_PANELS];
+    int buses[MAX_PANELS];
+    int npanels = 0, nbuses = 0;
+    double seconds = 5, t0, t;
+    unsigned long total;
+    int opt, i, k, used;
+
+    while ((opt = getopt(argc, argv, "s:")) != -1) {
+        if (opt != 's') {
+            fprintf(stderr, "usage: %s [-s seconds] /dev/lcd1602-*...\n",
+                    argv[0]);
+            return 2;
+        }
+        seconds = atof(optarg);
+    }
+    for (i = optind; i < argc && npanels < MAX_PANELS; i++) {
+        struct panel *p = &panels[npanels];
+
+        p->path = argv[i];
+        p->bus = panel_bus(argv[i]);
+        if (p->bus < 0) {
+            fprintf(stderr, "%s: not an lcd1602-<bus>-<addr> node\n", argv[i]);
+            return 2;
+        }
+        p->fd = open(argv[i], O_WRONLY);
+        if (p->fd < 0) {
+            perror(argv[i]);
+            return 1;
+        }
+        npanels++;
+    }
+    if (!npanels) {
+        fprintf(stderr, "usage: %s [-s seconds] /dev/lcd1602-*...\n", argv[0]);
+        return 2;
+    }
+
+    for (i = 0; i < npanels; i++)
+        buses[nbuses++] = panels[i].bus;
+    qsort(buses, nbuses, sizeof(buses[0]), cmp_int);
+    for (i = 1, k = 1; i < nbuses; i++)
+        if (buses[i] != buses[k - 1])
+            buses[k++] = buses[i];
+    nbuses = k;
+
+    printf("%-9s %-7s %12s\n", "adapters", "panels", "frames/sec");
+    for (k = 1; k <= nbuses; k++) {
+        used = 0;
+        running = 1;
+        for (i = 0; i < npanels; i++) {
+            panels[i].frames = 0;
+            panels[i].err = 0;
+            if (panels[i].bus > buses[k - 1])
+                continue;
+            pthread_create(&panels[i].thread, NULL, panel_run, &panels[i]);
+            used++;
+        }
+        t0 = now();
+        usleep((useconds_t)(seconds * 1e6));
+        running = 0;
+        total = 0;
+        for (i = 0; i < npanels; i++) {
+            if (panels[i].bus > buses[k - 1])
+                continue;
+            pthread_join(panels[i].thread, NULL);
+            if (panels[i].err)
+                fprintf(stderr, "%s: %s\n", panels[i].path,
+                        strerror(panels[i].err));
+            total += panels[i].frames;
+        }
+        t = now() - t0;
+        printf("%-9d %-7d %12.1f\n", k, used, total / t);
+    }
+
+    for (i = 0; i < npanels; i++)
+        close(panels[i].fd);
+    return 0;
+}